@@ -113,8 +113,8 @@ void compute_embeddings(const std::string& _name, EmbeddingInput& _input)
             f << score << std::endl;
         }
 
-        // Smooth embedding
-        const auto em_smoothed = smooth_paths(em, 1);
+        // Smooth embedding and remove the slivers introduced by smoothing
+        const auto em_smoothed = decimate(smooth_paths(em, 1));
 
         // Visualization
         auto cfg_style = gv::config(gv::no_grid, gv::no_outline, gv::background_color(RWTH_WHITE));
@@ -0,0 +1,121 @@
+#pragma once
+
+/**
+  * Small synthetic inputs for the tests in this directory.
+  */
+
+#include <LayoutEmbedding/EmbeddingInput.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+
+#include <array>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace LayoutEmbedding {
+
+/// Midpoint subdivision of the octahedron, projected to the unit sphere.
+/// Each round appends the new vertices, so the vertices of fewer rounds are a prefix of those of more rounds.
+/// The first six vertices are the octahedron corners.
+inline void subdivided_octahedron(const int _subdivisions, std::vector<tg::pos3>& _positions, std::vector<std::array<int, 3>>& _faces)
+{
+    _positions = {
+        { 1, 0, 0 }, { -1, 0, 0 },
+        { 0, 1, 0 }, { 0, -1, 0 },
+        { 0, 0, 1 }, { 0, 0, -1 },
+    };
+    _faces = {
+        { 0, 2, 4 }, { 2, 1, 4 }, { 1, 3, 4 }, { 3, 0, 4 },
+        { 2, 0, 5 }, { 1, 2, 5 }, { 3, 1, 5 }, { 0, 3, 5 },
+    };
+    for (int iter = 0; iter < _subdivisions; ++iter) {
+        std::map<std::pair<int, int>, int> midpoints;
+        auto midpoint = [&](int _a, int _b) {
+            const auto key = std::minmax(_a, _b);
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) {
+                return it->second;
+            }
+            _positions.push_back(tg::mix(_positions[_a], _positions[_b], 0.5f));
+            midpoints[key] = _positions.size() - 1;
+            return (int)_positions.size() - 1;
+        };
+
+        std::vector<std::array<int, 3>> new_faces;
+        for (const auto& f : _faces) {
+            const int m01 = midpoint(f[0], f[1]);
+            const int m12 = midpoint(f[1], f[2]);
+            const int m20 = midpoint(f[2], f[0]);
+            new_faces.push_back({ f[0], m01, m20 });
+            new_faces.push_back({ m01, f[1], m12 });
+            new_faces.push_back({ m20, m12, f[2] });
+            new_faces.push_back({ m01, m12, m20 });
+        }
+        _faces = new_faces;
+    }
+
+    for (auto& p : _positions) {
+        p = tg::pos3::zero + tg::normalize(p - tg::pos3::zero);
+    }
+}
+
+/// Fills an empty EmbeddingInput with a subdivided octahedron layout (_layout_subdivisions rounds),
+/// embedded into a finer subdivision of the same sphere (_target_subdivisions rounds).
+/// Layout vertex i is matched to target vertex i, except for the pairs in _swapped_landmarks,
+/// whose landmarks are swapped so that shortest paths around them run into conflicts.
+inline void make_subdivided_octahedron_input(
+        EmbeddingInput& _input,
+        const int _layout_subdivisions,
+        const int _target_subdivisions,
+        const std::vector<std::pair<int, int>>& _swapped_landmarks)
+{
+    LE_ASSERT_LEQ(_layout_subdivisions, _target_subdivisions);
+
+    std::vector<tg::pos3> positions;
+    std::vector<std::array<int, 3>> faces;
+
+    // Layout
+    subdivided_octahedron(_layout_subdivisions, positions, faces);
+    for (const auto& p : positions) {
+        const auto l_v = _input.l_m.vertices().add();
+        _input.l_pos[l_v] = p;
+    }
+    for (const auto& f : faces) {
+        _input.l_m.faces().add(_input.l_m.vertices()[pm::vertex_index(f[0])], _input.l_m.vertices()[pm::vertex_index(f[1])], _input.l_m.vertices()[pm::vertex_index(f[2])]);
+    }
+
+    // Target
+    subdivided_octahedron(_target_subdivisions, positions, faces);
+    for (const auto& p : positions) {
+        const auto t_v = _input.t_m.vertices().add();
+        _input.t_pos[t_v] = p;
+    }
+    for (const auto& f : faces) {
+        _input.t_m.faces().add(_input.t_m.vertices()[pm::vertex_index(f[0])], _input.t_m.vertices()[pm::vertex_index(f[1])], _input.t_m.vertices()[pm::vertex_index(f[2])]);
+    }
+
+    // Landmarks
+    for (const auto l_v : _input.l_m.vertices()) {
+        _input.l_matching_vertex[l_v] = _input.t_m.vertices()[l_v.idx];
+    }
+    for (const auto& [l_vi_A, l_vi_B] : _swapped_landmarks) {
+        std::swap(_input.l_matching_vertex[_input.l_m.vertices()[pm::vertex_index(l_vi_A)]], _input.l_matching_vertex[_input.l_m.vertices()[pm::vertex_index(l_vi_B)]]);
+    }
+}
+
+/// Fills an empty EmbeddingInput with an octahedron layout, embedded into a sphere
+/// obtained by _subdivisions rounds of midpoint subdivision of the octahedron.
+/// The first six target vertices are the octahedron corners.
+/// With _swap_landmarks, the landmarks of two adjacent layout vertices are swapped,
+/// so that several shortest paths run into conflicts.
+inline void make_octahedron_input(EmbeddingInput& _input, const int _subdivisions, const bool _swap_landmarks)
+{
+    // +x and +z are adjacent, but their antipodes are not swapped
+    std::vector<std::pair<int, int>> swapped_landmarks;
+    if (_swap_landmarks) {
+        swapped_landmarks.push_back({ 0, 4 });
+    }
+    make_subdivided_octahedron_input(_input, 0, _subdivisions, swapped_landmarks);
+}
+
+}
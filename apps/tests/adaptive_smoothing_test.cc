@@ -0,0 +1,54 @@
+/**
+  * Smooths a greedy embedding adaptively until convergence, then smooths the result again.
+  * Starting from a converged layout, every path is smoothed in the first round
+  * and at most once more afterwards.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/Greedy.hh>
+#include <LayoutEmbedding/PathSmoothing.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    Embedding em(input);
+    embed_greedy(em);
+    LE_ASSERT(em.is_complete());
+
+    AdaptiveSmoothingSettings settings;
+
+    AdaptiveSmoothingStats stats_initial;
+    const Embedding em_converged = smooth_paths_adaptive(em, settings, &stats_initial);
+    LE_ASSERT(stats_initial.converged);
+    LE_ASSERT(em_converged.is_complete());
+
+    AdaptiveSmoothingStats stats;
+    const Embedding em_resmoothed = smooth_paths_adaptive(em_converged, settings, &stats);
+    LE_ASSERT(stats.converged);
+    LE_ASSERT(em_resmoothed.is_complete());
+
+    int num_paths = 0;
+    for (const auto l_e : em_converged.layout_mesh().edges()) {
+        if (!l_e.is_boundary())
+            ++num_paths;
+    }
+
+    std::cout << "Initial: " << stats_initial.num_paths_processed << " paths processed in "
+              << stats_initial.max_displacement.size() << " rounds" << std::endl;
+    std::cout << "Converged: " << stats.num_paths_processed << " paths processed in "
+              << stats.max_displacement.size() << " rounds" << std::endl;
+
+    LE_ASSERT_GEQ(stats.num_paths_processed, num_paths);
+    LE_ASSERT_LEQ(stats.num_paths_processed - num_paths, num_paths);
+
+    return 0;
+}
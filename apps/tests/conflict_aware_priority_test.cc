@@ -0,0 +1,51 @@
+/**
+  * Compares the branch-and-bound search with and without conflict-aware node priorities.
+  * The priority only changes the order of expansion, so the optimum must not change,
+  * and the number of expanded nodes must not go up.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    BranchAndBoundSettings settings;
+    settings.optimality_gap = 0.0;
+    settings.time_limit = 0.0;
+    settings.use_greedy_init = false;
+    settings.print_current_insertion_sequence = false;
+    settings.print_memory_footprint_estimate = false;
+
+    BranchAndBoundSettings plain_settings = settings;
+    plain_settings.use_conflict_aware_priority = false;
+    Embedding em_plain(input);
+    const auto plain = branch_and_bound(em_plain, plain_settings, "plain");
+
+    BranchAndBoundSettings conflict_aware_settings = settings;
+    conflict_aware_settings.use_conflict_aware_priority = true;
+    Embedding em_conflict_aware(input);
+    const auto conflict_aware = branch_and_bound(em_conflict_aware, conflict_aware_settings, "conflict_aware");
+
+    std::cout << std::endl;
+    for (const auto& result : { plain, conflict_aware }) {
+        std::cout << result.algorithm << ": "
+                  << "cost " << result.cost << ", "
+                  << result.num_iters << " expanded nodes" << std::endl;
+    }
+
+    LE_ASSERT(!std::isinf(plain.cost));
+    LE_ASSERT_EPS(conflict_aware.cost, plain.cost, 1e-6 * plain.cost);
+    LE_ASSERT_LEQ(conflict_aware.num_iters, plain.num_iters);
+
+    return 0;
+}
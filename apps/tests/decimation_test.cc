@@ -0,0 +1,67 @@
+/**
+  * Decimates a smoothed embedding and checks that it is still consistent:
+  * every path is embedded with the same polyline, landmarks stay at their input positions,
+  * and no target halfedge carries a label that is not part of a path.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/Greedy.hh>
+#include <LayoutEmbedding/PathSmoothing.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    Embedding em(input);
+    embed_greedy(em);
+    LE_ASSERT(em.is_complete());
+
+    const Embedding em_smoothed = smooth_paths(em, 2);
+    const Embedding em_decimated = decimate(em_smoothed);
+
+    std::cout << "Smoothed: " << em_smoothed.target_mesh().vertices().size() << " vertices, "
+              << "decimated: " << em_decimated.target_mesh().vertices().size() << " vertices" << std::endl;
+    LE_ASSERT(em_decimated.is_complete());
+    LE_ASSERT_LEQ(em_decimated.target_mesh().vertices().size(), em_smoothed.target_mesh().vertices().size());
+    LE_ASSERT_GEQ(em_decimated.target_mesh().vertices().size(), input.t_m.vertices().size());
+
+    // Landmarks
+    for (const auto l_v : input.l_m.vertices()) {
+        const auto t_v = em_decimated.matching_target_vertex(l_v);
+        LE_ASSERT(t_v.is_valid());
+        LE_ASSERT(!t_v.is_removed());
+        LE_ASSERT(em_decimated.matching_layout_vertex(t_v) == l_v);
+        LE_ASSERT_EQ(t_v.idx.value, input.l_matching_vertex[l_v].idx.value);
+        LE_ASSERT_EQ(tg::distance(em_decimated.target_pos()[t_v], input.t_pos[input.l_matching_vertex[l_v]]), 0.0f);
+    }
+
+    // Paths
+    int num_path_halfedges = 0;
+    for (const auto l_h : input.l_m.halfedges()) {
+        const auto path_smoothed = em_smoothed.get_embedded_path(l_h);
+        const auto path_decimated = em_decimated.get_embedded_path(l_h);
+        LE_ASSERT_EQ(path_decimated.size(), path_smoothed.size());
+        LE_ASSERT(path_decimated.front() == em_decimated.matching_target_vertex(l_h.vertex_from()));
+        LE_ASSERT(path_decimated.back() == em_decimated.matching_target_vertex(l_h.vertex_to()));
+        for (int i = 0; i < (int)path_smoothed.size(); ++i)
+            LE_ASSERT_EQ(tg::distance(em_decimated.target_pos()[path_decimated[i]], em_smoothed.target_pos()[path_smoothed[i]]), 0.0f);
+        num_path_halfedges += path_decimated.size() - 1;
+    }
+
+    int num_labeled_halfedges = 0;
+    for (const auto t_h : em_decimated.target_mesh().halfedges()) {
+        if (em_decimated.matching_layout_halfedge(t_h).is_valid())
+            ++num_labeled_halfedges;
+    }
+    LE_ASSERT_EQ(num_labeled_halfedges, num_path_halfedges);
+
+    return 0;
+}
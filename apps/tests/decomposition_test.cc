@@ -0,0 +1,55 @@
+/**
+  * Compares the branch-and-bound search with and without conflict decomposition
+  * on a layout with two swaps of adjacent landmarks on opposite sides of the sphere.
+  * Both have to find the same optimum, and the decomposed search must not report a higher lower bound.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    // Vertex 6 is the midpoint of +x and +y, vertex 11 the midpoint of -x and -y.
+    // Their neighborhoods are disjoint.
+    EmbeddingInput input;
+    make_subdivided_octahedron_input(input, 1, 3, { { 0, 6 }, { 1, 11 } });
+
+    BranchAndBoundSettings settings;
+    settings.optimality_gap = 0.0;
+    settings.time_limit = 0.0;
+    settings.print_current_insertion_sequence = false;
+    settings.print_memory_footprint_estimate = false;
+
+    BranchAndBoundSettings joint_settings = settings;
+    joint_settings.use_conflict_decomposition = false;
+    Embedding em_joint(input);
+    const auto joint = branch_and_bound(em_joint, joint_settings, "joint");
+
+    BranchAndBoundSettings decomposed_settings = settings;
+    decomposed_settings.use_conflict_decomposition = true;
+    Embedding em_decomposed(input);
+    const auto decomposed = branch_and_bound(em_decomposed, decomposed_settings, "decomposed");
+
+    std::cout << std::endl;
+    for (const auto& result : { joint, decomposed }) {
+        std::cout << result.algorithm << ": "
+                  << "cost " << result.cost << ", "
+                  << "lower bound " << result.lower_bound << ", "
+                  << result.num_iters << " expanded nodes" << std::endl;
+    }
+
+    LE_ASSERT(em_joint.is_complete());
+    LE_ASSERT(em_decomposed.is_complete());
+    LE_ASSERT(!std::isinf(joint.cost));
+    LE_ASSERT_EPS(decomposed.cost, joint.cost, 1e-6 * joint.cost);
+    LE_ASSERT_LEQ(decomposed.lower_bound, decomposed.cost * (1.0 + 1e-6));
+
+    return 0;
+}
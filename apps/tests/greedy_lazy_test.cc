@@ -0,0 +1,47 @@
+/**
+  * Compares lazy (CELF) and exhaustive evaluation in the greedy embedding.
+  * Both have to insert the same edges in the same order, with the same cost.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/Greedy.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    std::vector<EmbeddingInput> inputs(3);
+    make_octahedron_input(inputs[0], 3, false);
+    make_octahedron_input(inputs[1], 3, true);
+    make_subdivided_octahedron_input(inputs[2], 1, 3, { { 0, 6 }, { 1, 11 } });
+
+    for (const bool prefer_extremal_vertices : { false, true }) {
+        for (auto& input : inputs) {
+            GreedySettings settings;
+            settings.prefer_extremal_vertices = prefer_extremal_vertices;
+
+            GreedySettings exhaustive_settings = settings;
+            exhaustive_settings.use_lazy_evaluation = false;
+            Embedding em_exhaustive(input);
+            const auto exhaustive = embed_greedy(em_exhaustive, exhaustive_settings, "exhaustive");
+
+            GreedySettings lazy_settings = settings;
+            lazy_settings.use_lazy_evaluation = true;
+            Embedding em_lazy(input);
+            const auto lazy = embed_greedy(em_lazy, lazy_settings, "lazy");
+
+            std::cout << "Exhaustive cost " << exhaustive.cost << ", lazy cost " << lazy.cost << std::endl;
+            LE_ASSERT(em_exhaustive.is_complete());
+            LE_ASSERT(em_lazy.is_complete());
+            LE_ASSERT(lazy.insertion_sequence == exhaustive.insertion_sequence);
+            LE_ASSERT_EPS(lazy.cost, exhaustive.cost, 1e-9 * exhaustive.cost);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+/**
+  * Computes harmonic fields on a finely subdivided sphere with LinearSolver::Automatic,
+  * which selects the multigrid solver above multigrid_solver_min_unknowns,
+  * and compares them to the direct solution, for both weight types.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/Harmonic.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+#include <glow-extras/timing/CpuTimer.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    // 262146 vertices
+    EmbeddingInput input;
+    make_octahedron_input(input, 8, false);
+    const auto& m = input.t_m;
+    const auto& pos = input.t_pos;
+
+    // Constrain a small cap around the south pole to the vertex coordinates
+    auto constrained = m.vertices().make_attribute<bool>(false);
+    Eigen::MatrixXd constraint_values = Eigen::MatrixXd::Zero(m.vertices().size(), 2);
+    int num_unknowns = 0;
+    for (const auto v : m.vertices()) {
+        constrained[v] = pos[v].z < -0.9f;
+        if (constrained[v]) {
+            constraint_values(v.idx.value, 0) = pos[v].x;
+            constraint_values(v.idx.value, 1) = pos[v].y;
+        }
+        else {
+            ++num_unknowns;
+        }
+    }
+    std::cout << num_unknowns << " unknowns" << std::endl;
+    LE_ASSERT_G(num_unknowns, multigrid_solver_min_unknowns);
+
+    for (const auto weights : { LaplaceWeights::Uniform, LaplaceWeights::MeanValue }) {
+        const HarmonicSolver automatic_solver(pos, constrained, weights, LinearSolver::Automatic);
+        LE_ASSERT(automatic_solver.ok());
+        LE_ASSERT(automatic_solver.is_iterative());
+
+        glow::timing::CpuTimer timer_automatic;
+        Eigen::MatrixXd res_automatic;
+        LE_ASSERT(harmonic(pos, constrained, constraint_values, res_automatic, weights, false, LinearSolver::Automatic));
+        const double t_automatic = timer_automatic.elapsedSecondsD();
+
+        glow::timing::CpuTimer timer_direct;
+        Eigen::MatrixXd res_direct;
+        LE_ASSERT(harmonic(pos, constrained, constraint_values, res_direct, weights, false, LinearSolver::Direct));
+        const double t_direct = timer_direct.elapsedSecondsD();
+
+        const double difference = (res_automatic - res_direct).cwiseAbs().maxCoeff();
+        std::cout << (weights == LaplaceWeights::Uniform ? "Uniform" : "MeanValue") << " weights: "
+                  << "automatic " << t_automatic << " s, direct " << t_direct << " s, "
+                  << "max difference " << difference << std::endl;
+        LE_ASSERT_L(difference, 1e-5);
+    }
+
+    return 0;
+}
@@ -0,0 +1,63 @@
+/**
+  * Checks incremental conflict detection against a full rebuild of the conflict sentinel.
+  * For each conflicting pair, the higher-index edge is embedded and the lower-index one is re-traced,
+  * so that the changed labels are processed in an order where stale paths are still present.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/EmbeddingState.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+    Embedding em(input);
+
+    BranchAndBoundSettings settings;
+    settings.use_incremental_conflict_detection = true;
+
+    EmbeddingState root(em, settings);
+    root.compute_all_candidate_paths();
+    root.detect_candidate_path_conflicts();
+    LE_ASSERT(root.valid());
+    LE_ASSERT(!root.conflicts.empty());
+
+    int num_checked = 0;
+    for (const auto& [l_ei_A, l_ei_B] : root.conflicts.pairs()) {
+        const auto l_ei_high = std::max(l_ei_A, l_ei_B);
+
+        EmbeddingState es(root); // Copy, keeps the sentinel
+        es.extend(l_ei_high, es.candidate_paths[es.em.layout_mesh().edges()[l_ei_high]]);
+        for (const auto& l_ei : es.get_conflicting_candidates(l_ei_high)) {
+            es.compute_candidate_path(l_ei);
+        }
+        if (!es.valid()) {
+            continue;
+        }
+
+        // set_candidate_paths() discards the sentinel, so this one is rebuilt from scratch
+        EmbeddingState es_rebuilt(es);
+        es_rebuilt.set_candidate_paths(es.candidate_paths.to_vector());
+
+        es.detect_candidate_path_conflicts();
+        es_rebuilt.detect_candidate_path_conflicts();
+
+        std::cout << "Embedded edge " << l_ei_high.value << ": "
+                  << es.conflicts.pairs().size() << " conflicts (incremental), "
+                  << es_rebuilt.conflicts.pairs().size() << " conflicts (rebuilt)" << std::endl;
+        LE_ASSERT(es.conflicts.pairs() == es_rebuilt.conflicts.pairs());
+        LE_ASSERT_EQ(es.num_conflicting_edges(), es_rebuilt.num_conflicting_edges());
+        ++num_checked;
+    }
+    LE_ASSERT_GEQ(num_checked, 1);
+
+    return 0;
+}
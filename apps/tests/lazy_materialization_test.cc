@@ -0,0 +1,53 @@
+/**
+  * Compares eager and lazy child materialization in the branch-and-bound search.
+  * Both have to find the same optimum, and the lazy variant must not trace more candidate paths.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    BranchAndBoundSettings settings;
+    settings.optimality_gap = 0.0;
+    settings.time_limit = 0.0;
+    settings.use_greedy_init = false;
+    settings.print_current_insertion_sequence = false;
+    settings.print_memory_footprint_estimate = false;
+
+    BranchAndBoundSettings eager_settings = settings;
+    eager_settings.use_lazy_child_materialization = false;
+    Embedding em_eager(input);
+    const auto eager = branch_and_bound(em_eager, eager_settings, "eager");
+
+    BranchAndBoundSettings lazy_settings = settings;
+    lazy_settings.use_lazy_child_materialization = true;
+    Embedding em_lazy(input);
+    const auto lazy = branch_and_bound(em_lazy, lazy_settings, "lazy");
+
+    std::cout << std::endl;
+    for (const auto& result : { eager, lazy }) {
+        std::cout << result.algorithm << ": "
+                  << "cost " << result.cost << ", "
+                  << result.num_iters << " expanded nodes, "
+                  << result.num_traced_paths << " traced paths" << std::endl;
+    }
+
+    LE_ASSERT(em_eager.is_complete());
+    LE_ASSERT(em_lazy.is_complete());
+    LE_ASSERT(!std::isinf(eager.cost));
+    LE_ASSERT_EPS(lazy.cost, eager.cost, 1e-6 * eager.cost);
+    LE_ASSERT_LEQ(lazy.num_traced_paths, eager.num_traced_paths);
+
+    return 0;
+}
@@ -0,0 +1,70 @@
+/**
+  * Solves a grid Laplacian with multigrid-preconditioned CG and compares the result to a sparse Cholesky solve.
+  * Prints the number of levels and iterations.
+  */
+
+#include <LayoutEmbedding/Multigrid.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+
+#include <iostream>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    // 5-point Laplacian on an N x N grid, with the boundary neighbors eliminated (Dirichlet),
+    // which makes it symmetric positive definite
+    const int N = 150;
+    const int n = N * N;
+    std::vector<Eigen::Triplet<double>> triplets;
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const int i = y * N + x;
+            const int neighbors[4][2] = { { x - 1, y }, { x + 1, y }, { x, y - 1 }, { x, y + 1 } };
+            for (const auto& nb : neighbors) {
+                if (nb[0] >= 0 && nb[0] < N && nb[1] >= 0 && nb[1] < N) {
+                    triplets.emplace_back(i, nb[1] * N + nb[0], -1.0);
+                }
+            }
+            triplets.emplace_back(i, i, 4.0);
+        }
+    }
+    Eigen::SparseMatrix<double> A(n, n);
+    A.setFromTriplets(triplets.begin(), triplets.end());
+
+    std::srand(0);
+    const Eigen::VectorXd b = Eigen::VectorXd::Random(n);
+
+    // Multigrid
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper, MultigridPreconditioner> mg_cg;
+    mg_cg.setTolerance(1e-10);
+    mg_cg.compute(A);
+    LE_ASSERT(mg_cg.info() == Eigen::Success);
+    const Eigen::VectorXd x_mg = mg_cg.solve(b);
+    LE_ASSERT(mg_cg.info() == Eigen::Success);
+
+    // Reference
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt(A);
+    LE_ASSERT(ldlt.info() == Eigen::Success);
+    const Eigen::VectorXd x_ldlt = ldlt.solve(b);
+
+    const double residual_mg = (A * x_mg - b).norm() / b.norm();
+    const double residual_ldlt = (A * x_ldlt - b).norm() / b.norm();
+    const double difference = (x_mg - x_ldlt).norm() / x_ldlt.norm();
+    std::cout << "Multigrid: " << mg_cg.preconditioner().num_levels() << " levels, "
+              << mg_cg.iterations() << " iterations, relative residual " << residual_mg << std::endl;
+    std::cout << "LDLT: relative residual " << residual_ldlt << std::endl;
+    std::cout << "Relative difference of the solutions: " << difference << std::endl;
+
+    LE_ASSERT_GEQ(mg_cg.preconditioner().num_levels(), 2);
+    LE_ASSERT_L(residual_mg, 1e-8);
+    LE_ASSERT_L(difference, 1e-6);
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+  * Compares the node selection strategies of the branch-and-bound search.
+  * All strategies have to find the same optimum as best-first search.
+  * Plunging and greedy completion must not expand more nodes than best-first search
+  * before they find their first upper bound.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    BranchAndBoundSettings base_settings;
+    base_settings.optimality_gap = 0.0; // Exact optimum, so all strategies agree
+    base_settings.time_limit = 0.0;
+    base_settings.use_greedy_init = false; // Strategies have to find upper bounds themselves
+    base_settings.print_current_insertion_sequence = false;
+    base_settings.print_memory_footprint_estimate = false;
+
+    struct Run
+    {
+        std::string name;
+        BranchAndBoundSettings settings;
+    };
+    std::vector<Run> runs;
+    {
+        Run run { "best_first", base_settings };
+        runs.push_back(run);
+    }
+    {
+        Run run { "plunging", base_settings };
+        run.settings.node_selection = BranchAndBoundSettings::NodeSelection::DepthFirstPlunging;
+        runs.push_back(run);
+    }
+    {
+        Run run { "limited_discrepancy", base_settings };
+        run.settings.node_selection = BranchAndBoundSettings::NodeSelection::LimitedDiscrepancy;
+        runs.push_back(run);
+    }
+    {
+        Run run { "best_first_greedy_completion", base_settings };
+        run.settings.greedy_completion_period = 10;
+        runs.push_back(run);
+    }
+
+    std::vector<BranchAndBoundResult> results;
+    for (const auto& run : runs) {
+        Embedding em(input);
+        results.push_back(branch_and_bound(em, run.settings, run.name));
+        LE_ASSERT(em.is_complete());
+    }
+
+    std::cout << std::endl;
+    std::vector<int> first_upper_bound_iters;
+    for (const auto& result : results) {
+        // The first event is the initial (infinite) upper bound
+        LE_ASSERT_GEQ(result.upper_bound_events.size(), 2);
+        const auto& first_upper_bound = result.upper_bound_events[1];
+        first_upper_bound_iters.push_back(first_upper_bound.num_iters);
+        std::cout << result.algorithm << ": "
+                  << "cost " << result.cost << ", "
+                  << result.num_iters << " expanded nodes, "
+                  << "first upper bound after " << first_upper_bound.num_iters << " expanded nodes, "
+                  << first_upper_bound.t << " s" << std::endl;
+    }
+
+    const double optimum = results.front().cost;
+    LE_ASSERT(!std::isinf(optimum));
+    for (const auto& result : results) {
+        LE_ASSERT_EPS(result.cost, optimum, 1e-6 * optimum);
+    }
+
+    // Indices into runs
+    const int best_first = 0;
+    const int plunging = 1;
+    const int greedy_completion = 3;
+    LE_ASSERT_LEQ(first_upper_bound_iters[plunging], first_upper_bound_iters[best_first]);
+    LE_ASSERT_LEQ(first_upper_bound_iters[greedy_completion], first_upper_bound_iters[best_first]);
+
+    return 0;
+}
@@ -0,0 +1,52 @@
+/**
+  * Compares parallel path smoothing to sequential smoothing of the same edges in class order.
+  * Both have to produce the same target mesh and the same embedded paths.
+  */
+
+#include "TestInputs.hh"
+
+#include <LayoutEmbedding/Greedy.hh>
+#include <LayoutEmbedding/PathSmoothing.hh>
+#include <LayoutEmbedding/Util/Assert.hh>
+#include <LayoutEmbedding/Util/StackTrace.hh>
+
+using namespace LayoutEmbedding;
+
+int main()
+{
+    register_segfault_handler();
+
+    EmbeddingInput input;
+    make_octahedron_input(input, 3, true);
+
+    Embedding em(input);
+    embed_greedy(em);
+    LE_ASSERT(em.is_complete());
+
+    const auto l_edges = em.layout_mesh().edges().to_vector();
+    std::vector<pm::edge_handle> l_edges_class_order;
+    for (const auto& l_class : disjoint_flap_classes(l_edges))
+        l_edges_class_order.insert(l_edges_class_order.end(), l_class.begin(), l_class.end());
+    LE_ASSERT_EQ(l_edges_class_order.size(), l_edges.size());
+
+    const int n_iters = 2;
+    const Embedding em_sequential = smooth_paths(em, l_edges_class_order, n_iters, true, false);
+    const Embedding em_parallel = smooth_paths(em, l_edges, n_iters, true, true);
+
+    LE_ASSERT(em_sequential.is_complete());
+    LE_ASSERT(em_parallel.is_complete());
+    LE_ASSERT_EQ(em_parallel.target_mesh().vertices().size(), em_sequential.target_mesh().vertices().size());
+
+    for (const auto l_e : em.layout_mesh().edges()) {
+        const auto path_sequential = em_sequential.get_embedded_path(l_e.halfedgeA());
+        const auto path_parallel = em_parallel.get_embedded_path(l_e.halfedgeA());
+        LE_ASSERT_EQ(path_parallel.size(), path_sequential.size());
+        for (int i = 0; i < (int)path_sequential.size(); ++i) {
+            const auto p_sequential = em_sequential.target_pos()[path_sequential[i]];
+            const auto p_parallel = em_parallel.target_pos()[path_parallel[i]];
+            LE_ASSERT_EPS(tg::distance(p_parallel, p_sequential), 0.0, 1e-6);
+        }
+    }
+
+    return 0;
+}
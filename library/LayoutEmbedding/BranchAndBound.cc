@@ -2,8 +2,9 @@
 
 #include <LayoutEmbedding/Connectivity.hh>
 #include <LayoutEmbedding/EmbeddingState.hh>
-#include <LayoutEmbedding/GetQueueContainer.hh>
 #include <LayoutEmbedding/Greedy.hh>
+#include <LayoutEmbedding/NodeSelection.hh>
+#include <LayoutEmbedding/UnionFind.hh>
 #include <LayoutEmbedding/Util/Assert.hh>
 
 #include <glow-extras/timing/CpuTimer.hh>
@@ -20,88 +21,284 @@ struct State
     pm::edge_index l_e;
     VirtualPath path;
     std::vector<VirtualPath> candidate_paths;
-    std::set<std::pair<pm::edge_index, pm::edge_index>> candidate_conflicts;
+    std::vector<ConflictGraph::Conflict> candidate_conflicts;
+    double conflict_cost_increase = 0.0;
 };
 
-struct Candidate
+namespace {
+
+struct SearchResult
 {
+    InsertionSequence insertion_sequence;
+
+    double upper_bound = std::numeric_limits<double>::infinity();
     double lower_bound = std::numeric_limits<double>::infinity();
-    double priority = 0.0;
+    double gap = 1.0;
 
-    HashValue state_hash;
+    double max_state_tree_memory_estimate = 0.0; // Bytes
+    int num_iters = 0;
+    int num_traced_paths = 0;
 
-    bool operator<(const Candidate& _rhs) const
-    {
-        return priority > _rhs.priority;
-    }
+    // Set if a restricted search encountered a conflict between one of its own edges and an excluded edge.
+    bool interaction_detected = false;
 };
 
-BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettings& _settings, const std::string& _name)
+/// Best-first search over insertion sequences, starting at the root state _root.
+/// Edges in _excluded_edges are never inserted. If any of them comes into conflict
+/// with a non-excluded edge, the search is aborted and reports interaction_detected.
+/// Bound events are only recorded if _result is given.
+SearchResult search(
+        const EmbeddingState& _root,
+        const BranchAndBoundSettings& _settings,
+        const std::set<pm::edge_index>& _excluded_edges,
+        const double _initial_upper_bound,
+        const InsertionSequence& _initial_insertion_sequence,
+        const glow::timing::CpuTimer& _timer,
+        BranchAndBoundResult* _result)
 {
-    glow::timing::CpuTimer timer;
-
-    BranchAndBoundResult result(_name, _settings);
+    const auto& timer = _timer;
 
-    InsertionSequence best_insertion_sequence;
-    double global_upper_bound = std::numeric_limits<double>::infinity();
+    SearchResult result;
 
-    if (_settings.record_lower_bound_events) {
-        BranchAndBoundResult::LowerBoundEvent event;
-        event.t = 0.0;
-        event.lower_bound = 0.0;
-        result.lower_bound_events.push_back(event);
-    }
+    InsertionSequence best_insertion_sequence = _initial_insertion_sequence;
+    double global_upper_bound = _initial_upper_bound;
+    int iter = 0; // Number of expanded nodes
 
-    if (_settings.record_upper_bound_events) {
-        BranchAndBoundResult::UpperBoundEvent event;
-        event.t = 0.0;
-        event.upper_bound = std::numeric_limits<double>::infinity();
-        result.upper_bound_events.push_back(event);
-    }
-
-    // Run heuristic algorithm to find a tighter initial upper bound.
-    if (_settings.use_greedy_init) {
-        Embedding em(_em);
-        const auto results = embed_competitors(em);
-        global_upper_bound = em.total_embedded_path_length();
-        best_insertion_sequence = best(results).insertion_sequence;
-
-        if (_settings.record_upper_bound_events) {
+    // Does any conflict connect an excluded edge with a non-excluded one?
+    auto crosses_exclusion = [&](const EmbeddingState& _es) {
+        for (const auto& [l_ei_A, l_ei_B] : _es.conflicts) {
+            if (_excluded_edges.count(l_ei_A) != _excluded_edges.count(l_ei_B)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Edges that may be inserted next in the given state
+    auto get_insertion_options = [&](const EmbeddingState& _es) {
+        std::set<pm::edge_index> insertion_options;
+        if (_settings.use_proactive_pruning) {
+            insertion_options = _es.conflicting_edges();
+        }
+        else {
+            insertion_options = _es.unembedded_edges();
+        }
+        for (const auto& l_e : _excluded_edges) {
+            insertion_options.erase(l_e);
+        }
+        return insertion_options;
+    };
+
+    auto update_upper_bound = [&](const double _cost, const InsertionSequence& _insertion_sequence) {
+        global_upper_bound = _cost;
+        best_insertion_sequence = _insertion_sequence;
+        std::cout << "New upper bound: " << global_upper_bound << std::endl;
+        if (_result && _settings.record_upper_bound_events) {
             BranchAndBoundResult::UpperBoundEvent event;
             event.t = timer.elapsedSecondsD();
             event.upper_bound = global_upper_bound;
-            result.upper_bound_events.push_back(event);
+            event.num_iters = iter;
+            _result->upper_bound_events.push_back(event);
         }
-    }
+    };
+
+    // Completes _es by repeatedly inserting the insertion option with the shortest candidate path.
+    // Returns the cost of the completed layout, or infinity if a dead end is reached.
+    auto complete_greedily = [&](EmbeddingState& _es, InsertionSequence& _insertion_sequence) {
+        while (true) {
+            if (!_es.valid()) {
+                return std::numeric_limits<double>::infinity();
+            }
+            if (!_excluded_edges.empty() && crosses_exclusion(_es)) {
+                return std::numeric_limits<double>::infinity();
+            }
+
+            const auto insertion_options = get_insertion_options(_es);
+            if (insertion_options.empty()) {
+                return _es.cost_lower_bound();
+            }
+
+            pm::edge_index best_l_e;
+            double best_length = std::numeric_limits<double>::infinity();
+            for (const auto& l_e : insertion_options) {
+                const double length = _es.candidate_path_length(l_e);
+                if (length < best_length) {
+                    best_length = length;
+                    best_l_e = l_e;
+                }
+            }
+
+            _es.extend(best_l_e, _es.candidate_paths[best_l_e]);
+            _insertion_sequence.push_back(best_l_e);
+            for (const auto& l_e_conflicting : _es.get_conflicting_candidates(best_l_e)) {
+                _es.compute_candidate_path(l_e_conflicting);
+            }
+            _es.detect_candidate_path_conflicts();
+        }
+    };
 
     std::map<HashValue, State> known_states;
     {
-        EmbeddingState es(_em, _settings);
-        es.compute_all_candidate_paths();
-        es.detect_candidate_path_conflicts();
-
         State root;
         root.parent = 0;
-        root.candidate_paths = es.candidate_paths.to_vector();
-        root.candidate_conflicts = es.conflicts;
+        root.candidate_paths = _root.candidate_paths.to_vector();
+        root.candidate_conflicts = _root.conflicts.pairs();
+        root.conflict_cost_increase = _root.conflict_cost_increase;
 
         known_states[0] = root;
     }
 
-    // Init priority queue with empty state.
-    std::priority_queue<Candidate> q;
+    // Lengths of the unblocked root candidate paths.
+    // A path of an edge can only get longer as more paths get embedded,
+    // so these are valid lower bounds for that edge anywhere in the search tree.
+    std::vector<double> root_candidate_lengths(_root.em.layout_mesh().edges().size(), 0.0);
+    for (const auto l_e : _root.em.layout_mesh().edges()) {
+        if (!_root.em.is_embedded(l_e)) {
+            root_candidate_lengths[l_e.idx.value] = _root.candidate_path_length(l_e);
+        }
+    }
+
+    // Mirrors EmbeddingState::cost_lower_bound(), given (lower bounds on) the embedded and unembedded cost.
+    auto combine_lower_bound = [&](const double _embedded_cost, const double _unembedded_cost) {
+        if (_settings.use_candidate_paths_for_lower_bounds) {
+            return _embedded_cost + _unembedded_cost;
+        }
+        else if (std::isinf(_unembedded_cost)) {
+            return std::numeric_limits<double>::infinity();
+        }
+        else {
+            return _embedded_cost;
+        }
+    };
+
+    auto prunable = [&](const double _lower_bound) {
+        return 1.0 - _lower_bound / global_upper_bound < _settings.optimality_gap;
+    };
+
+    auto compute_priority = [&](const double _lower_bound, const int _num_conflicting) {
+        if (_settings.priority == BranchAndBoundSettings::Priority::LowerBoundNonConflicting) {
+            return _lower_bound * _num_conflicting;
+        }
+        else if (_settings.priority == BranchAndBoundSettings::Priority::LowerBound) {
+            return _lower_bound;
+        }
+        else {
+            LE_ASSERT(false);
+            return _lower_bound;
+        }
+    };
+
+    // Per-edge lower bounds of a state: the current candidate path length, but at least the root candidate path length.
+    struct EdgeBounds
+    {
+        double embedded_cost = 0.0;
+        double unembedded_lower_bound = 0.0;
+        std::vector<double> lower_bounds;
+        std::vector<double> candidate_lengths;
+    };
+    auto compute_edge_bounds = [&](const EmbeddingState& _es) {
+        EdgeBounds bounds;
+        bounds.embedded_cost = _es.embedded_cost();
+        bounds.lower_bounds.resize(_es.em.layout_mesh().edges().size(), 0.0);
+        bounds.candidate_lengths.resize(_es.em.layout_mesh().edges().size(), 0.0);
+        for (const auto l_e : _es.em.layout_mesh().edges()) {
+            if (!_es.em.is_embedded(l_e)) {
+                const double length = _es.candidate_path_length(l_e);
+                bounds.candidate_lengths[l_e.idx.value] = length;
+                bounds.lower_bounds[l_e.idx.value] = std::max(length, root_candidate_lengths[l_e.idx.value]);
+                bounds.unembedded_lower_bound += bounds.lower_bounds[l_e.idx.value];
+            }
+        }
+        return bounds;
+    };
+
+    // Stage 1: Cheap pre-bound of the child inserting _l_e, computed from the parent's cached values only.
+    // The inserted path keeps its candidate length, all other edges contribute their cached lower bound.
+    auto child_pre_bound = [&](const EdgeBounds& _bounds, const pm::edge_index& _l_e) {
+        return combine_lower_bound(
+                    _bounds.embedded_cost + _bounds.candidate_lengths[_l_e.value],
+                    _bounds.unembedded_lower_bound - _bounds.lower_bounds[_l_e.value]);
+    };
+
+    // Turns _es, a copy of the state _parent_hash, into its child that inserts _l_e.
+    // Stores the child in known_states and describes it in _c.
+    // Returns false if the child is already known or can be pruned.
+    auto materialize_child = [&](EmbeddingState& _es, const HashValue _parent_hash, const pm::edge_index& _l_e, const EdgeBounds& _bounds, Candidate& _c) {
+        // Update the state by adding the new child halfedge
+        const VirtualPath path = _es.candidate_paths[_l_e];
+        _es.extend(_l_e, path);
+
+        // Early-out if the resulting state is already known
+        const HashValue hash = _es.hash();
+
+        // TODO: re-enable? remove?
+        //if (_settings.use_state_hashing) {
+        if (known_states.count(hash)) {
+            return false;
+        }
+        //}
+
+        // Stage 2: Update candidate paths that were in conflict with the newly inserted edge.
+        // Tighten the bound after each re-traced path and stop as soon as the child can be pruned.
+        const double child_embedded_cost = _bounds.embedded_cost + _bounds.candidate_lengths[_l_e.value];
+        double child_unembedded_lower_bound = _bounds.unembedded_lower_bound - _bounds.lower_bounds[_l_e.value];
+        for (const auto& l_e_conflicting : _es.get_conflicting_candidates(_l_e)) {
+            _es.compute_candidate_path(l_e_conflicting);
+            ++result.num_traced_paths;
+
+            const double length = _es.candidate_path_length(l_e_conflicting);
+            child_unembedded_lower_bound += length - _bounds.lower_bounds[l_e_conflicting.value];
+            if (prunable(combine_lower_bound(child_embedded_cost, child_unembedded_lower_bound))) {
+                return false;
+            }
+        }
+
+        // Pruning
+        const double lower_bound = _es.cost_lower_bound();
+        if (prunable(lower_bound)) {
+            return false;
+        }
+
+        // Recompute all conflicts
+        _es.detect_candidate_path_conflicts();
+
+        // A restricted search must not interfere with the excluded edges
+        if (!_excluded_edges.empty() && crosses_exclusion(_es)) {
+            result.interaction_detected = true;
+            return false;
+        }
+
+        // Create a new state
+        State new_state;
+        new_state.parent = _parent_hash;
+        new_state.l_e = _l_e;
+        new_state.path = path;
+        new_state.candidate_paths = _es.candidate_paths.to_vector();
+        new_state.candidate_conflicts = _es.conflicts.pairs();
+        new_state.conflict_cost_increase = _es.conflict_cost_increase;
+
+        // Save the new state
+        known_states.emplace(hash, new_state);
+        known_states[_parent_hash].children.push_back(hash);
+
+        _c.materialized = true;
+        _c.state_hash = hash;
+        _c.lower_bound = lower_bound;
+        _c.priority = compute_priority(_es.cost_estimate(), _es.num_conflicting_edges());
+        return true;
+    };
+
+    // Init queue with empty state.
+    auto q = make_node_selection_strategy(_settings);
     {
         Candidate c;
         c.lower_bound = 0.0;
         c.priority = 0.0;
         c.state_hash = 0;
-        q.push(c);
+        q->push(c);
     }
 
-    int iter = 0;
-    while (!q.empty()) {
-        ++iter;
-
+    while (!q->empty()) {
         // Time limit
         if (_settings.time_limit > 0.0) {
             if (timer.elapsedSecondsD() >= _settings.time_limit) {
@@ -120,8 +317,7 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
             }
         }
 
-        auto c = q.top();
-        q.pop();
+        auto c = q->pop();
 
         // Early-out based on lower bound cached in c.
         double gap = 1.0 - c.lower_bound / global_upper_bound;
@@ -129,10 +325,13 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
             continue;
         }
 
+        // Unmaterialized candidates are evaluated starting from their parent state
+        const HashValue reconstructed_hash = c.materialized ? c.state_hash : c.parent_hash;
+
         // Reconstruct the embedding sequence and inserted paths by traversing the state graph
         InsertionSequence insertion_sequence;
         std::vector<const VirtualPath*> inserted_paths;
-        HashValue current_state_hash = c.state_hash;
+        HashValue current_state_hash = reconstructed_hash;
         while (current_state_hash != 0) {
             LE_ASSERT_G(known_states.count(current_state_hash), 0);
             const State& state = known_states[current_state_hash];
@@ -144,7 +343,7 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
         std::reverse(inserted_paths.begin(), inserted_paths.end());
 
         // Reconstruct the embedding associated with this state
-        EmbeddingState es(_em, _settings);
+        EmbeddingState es(_root.em, _settings);
         LE_ASSERT_EQ(insertion_sequence.size(), inserted_paths.size());
         for (size_t i = 0; i < insertion_sequence.size(); ++i) {
             const pm::edge_index& l_e = insertion_sequence[i];
@@ -152,17 +351,17 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
             es.extend(l_e, path);
         }
 
-        LE_ASSERT_EQ(es.hash(), c.state_hash);
+        LE_ASSERT_EQ(es.hash(), reconstructed_hash);
 
         // Reconstruct candidate paths
-        auto& state = known_states[c.state_hash];
-        es.candidate_paths.clear();
-        for (const auto l_e : es.em.layout_mesh().edges()) {
-            es.candidate_paths[l_e] = state.candidate_paths[l_e.idx.value];
-        }
+        {
+            const auto& state = known_states[reconstructed_hash];
+            es.set_candidate_paths(state.candidate_paths);
 
-        // Reconstruct candidate conflicts
-        es.conflicts = state.candidate_conflicts;
+            // Reconstruct candidate conflicts
+            es.set_conflicts(ConflictGraph(state.candidate_conflicts));
+            es.conflict_cost_increase = state.conflict_cost_increase;
+        }
 
         if (!es.valid()) {
             // The current embedding might be invalid if paths run into dead ends.
@@ -170,16 +369,28 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
             continue;
         }
 
+        // Fully evaluate a lazily pushed child now that it has been selected.
+        // Its exact bound and priority differ from the estimates it was queued with,
+        // so it is queued again instead of being expanded right away.
+        if (!c.materialized) {
+            const EdgeBounds parent_bounds = compute_edge_bounds(es);
+            if (!materialize_child(es, c.parent_hash, c.l_e, parent_bounds, c)) {
+                if (result.interaction_detected) {
+                    break;
+                }
+                continue;
+            }
+            q->push(c);
+            continue;
+        }
+
+        ++iter;
+
         if (c.lower_bound > 0) {
             // TODO
             //LE_ASSERT_EQ(es.cost_lower_bound(), c.lower_bound);
         }
 
-        // Cache classified edges
-        const auto& es_embedded_edges = es.embedded_edges();
-        const auto& es_conflicting_edges = es.conflicting_edges();
-        const auto& es_non_conflicting_edges = es.non_conflicting_edges();
-
         std::cout << "t: " << timer.elapsedSecondsD();
         std::cout << "    ";
         std::cout << "global UB: " << global_upper_bound;
@@ -188,13 +399,13 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
         std::cout << "    ";
         std::cout << "local gap: " << (gap * 100.0) << " %";
         std::cout << "    ";
-        std::cout << "|Embd|: " << es_embedded_edges.size();
+        std::cout << "|Embd|: " << es.num_embedded_edges();
         std::cout << "    ";
-        std::cout << "|Conf|: " << es_conflicting_edges.size();
+        std::cout << "|Conf|: " << es.num_conflicting_edges();
         std::cout << "    ";
-        std::cout << "|Ncnf|: " << es_non_conflicting_edges.size();
+        std::cout << "|Ncnf|: " << es.num_non_conflicting_edges();
         std::cout << "    ";
-        std::cout << "|Q|: " << q.size();
+        std::cout << "|Q|: " << q->size();
         std::cout << "    ";
         std::cout << "|H|: " << known_states.size();
         if (_settings.print_current_insertion_sequence) {
@@ -206,21 +417,18 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
         }
         std::cout << std::endl;
 
-        if (_settings.record_lower_bound_events && !q.empty()) {
-            double min_lower_bound = std::numeric_limits<double>::infinity();
-            for (const auto& q_item : get_container(q)) {
-                min_lower_bound = std::min(min_lower_bound, q_item.lower_bound);
-            }
+        if (_result && _settings.record_lower_bound_events && !q->empty()) {
+            double min_lower_bound = q->min_lower_bound();
             min_lower_bound = std::min(min_lower_bound, global_upper_bound);
 
             // Only record this event if it's an update
-            if (!result.lower_bound_events.empty()) {
-                const auto& last_lower_bound = result.lower_bound_events.back();
+            if (!_result->lower_bound_events.empty()) {
+                const auto& last_lower_bound = _result->lower_bound_events.back();
                 if (min_lower_bound > last_lower_bound.lower_bound) { // Don't save redundant lower bound updates
                     BranchAndBoundResult::LowerBoundEvent event;
                     event.t = timer.elapsedSecondsD();
                     event.lower_bound = min_lower_bound;
-                    result.lower_bound_events.push_back(event);
+                    _result->lower_bound_events.push_back(event);
                 }
             }
         }
@@ -231,7 +439,7 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
                 double estimated_memory;
 
                 // Estimate memory of queue
-                estimated_memory += q.size() * sizeof (Candidate);
+                estimated_memory += q->size() * sizeof (Candidate);
 
                 // Estimate memory of state tree
                 for (const auto& [hash, state] : known_states) {
@@ -273,108 +481,89 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
             }
         }
 
-        if (es.cost_lower_bound() < global_upper_bound) {
-            std::set<pm::edge_index> insertion_options;
-            if (_settings.use_proactive_pruning) {
-                insertion_options = es_conflicting_edges;
-            }
-            else {
-                insertion_options = es.unembedded_edges();
+        // Greedily complete this state to find a new upper bound early
+        if (_settings.greedy_completion_period > 0 && (iter - 1) % _settings.greedy_completion_period == 0 && es.cost_lower_bound() < global_upper_bound) {
+            EmbeddingState greedy_es(es); // Copy
+            InsertionSequence greedy_insertion_sequence = insertion_sequence;
+            const double greedy_cost = complete_greedily(greedy_es, greedy_insertion_sequence);
+            if (greedy_cost < global_upper_bound) {
+                update_upper_bound(greedy_cost, greedy_insertion_sequence);
             }
+        }
+
+        if (es.cost_lower_bound() < global_upper_bound) {
+            const auto insertion_options = get_insertion_options(es);
 
             // Completed layout?
             if (insertion_options.empty()) {
-                global_upper_bound = es.cost_lower_bound();
-                best_insertion_sequence = insertion_sequence;
-                std::cout << "New upper bound: " << global_upper_bound << std::endl;
-                if (_settings.record_upper_bound_events) {
-                    BranchAndBoundResult::UpperBoundEvent event;
-                    event.t = timer.elapsedSecondsD();
-                    event.upper_bound = global_upper_bound;
-                    result.upper_bound_events.push_back(event);
-                }
+                update_upper_bound(es.cost_lower_bound(), insertion_sequence);
             }
             else {
+                std::vector<Candidate> children;
+                const EdgeBounds bounds = compute_edge_bounds(es);
+
+                // Children copy the conflict sentinel of this state and only update their changed paths
+                if (!_settings.use_lazy_child_materialization && _settings.use_incremental_conflict_detection) {
+                    es.detect_candidate_path_conflicts();
+                }
+
                 // Add children to the queue
                 for (const auto& l_e : insertion_options) {
                     if (es.candidate_paths[l_e].empty()) {
                         continue;
                     }
 
-                    EmbeddingState new_es(es); // Copy
-
-                    // Update new state by adding the new child halfedge
-                    new_es.extend(l_e, es.candidate_paths[l_e]);
-
-                    // Early-out if the resulting state is already known
-                    const HashValue new_es_hash = new_es.hash();
-
-                    // TODO: re-enable? remove?
-                    //if (_settings.use_state_hashing) {
-                    if (known_states.count(new_es_hash)) {
-                        continue;
-                    }
-                    //}
-
-                    // Update candidate paths that were in conflict with the newly inserted edge
-                    for (const auto& l_e_conflicting : new_es.get_conflicting_candidates(l_e)) {
-                        new_es.compute_candidate_path(l_e_conflicting);
-                    }
-
-                    // Pruning
-                    const double new_lower_bound = new_es.cost_lower_bound();
-                    const double new_gap = 1.0 - new_lower_bound / global_upper_bound;
-                    if (new_gap < _settings.optimality_gap) {
+                    // Cheap pre-bound before copying the state
+                    const double pre_bound = child_pre_bound(bounds, l_e);
+                    if (prunable(pre_bound)) {
                         continue;
                     }
 
-                    // Recompute all conflicts
-                    new_es.detect_candidate_path_conflicts();
-
-                    // Create a new state
-                    State new_state;
-                    new_state.parent = c.state_hash;
-                    new_state.l_e = l_e;
-                    new_state.path = es.candidate_paths[l_e];
-                    new_state.candidate_paths = new_es.candidate_paths.to_vector();
-                    new_state.candidate_conflicts = new_es.conflicts;
-
-                    // Save the new state
-                    known_states.emplace(new_es_hash, new_state);
-                    state.children.push_back(new_es_hash);
-
-                    // Insert a corresponding element into the queue
                     Candidate new_c;
-                    new_c.state_hash = new_es_hash;
-                    new_c.lower_bound = new_lower_bound;
-                    if (_settings.priority == BranchAndBoundSettings::Priority::LowerBoundNonConflicting) {
-                        new_c.priority = new_c.lower_bound * new_es.conflicting_edges().size();
-                    }
-                    else if (_settings.priority == BranchAndBoundSettings::Priority::LowerBound) {
-                        new_c.priority = new_c.lower_bound;
+                    if (_settings.use_lazy_child_materialization) {
+                        // Only describe the child. Its conflict count is unknown before materialization,
+                        // so the parent's count stands in for it. This keeps the priority on the same scale
+                        // as that of materialized nodes, which would otherwise all be ranked behind lazy children.
+                        new_c.materialized = false;
+                        new_c.parent_hash = c.state_hash;
+                        new_c.l_e = l_e;
+                        new_c.lower_bound = pre_bound;
+                        new_c.priority = compute_priority(pre_bound, es.num_conflicting_edges());
                     }
                     else {
-                        LE_ASSERT(false);
+                        EmbeddingState new_es(es); // Copy
+                        if (!materialize_child(new_es, c.state_hash, l_e, bounds, new_c)) {
+                            if (result.interaction_detected) {
+                                break;
+                            }
+                            continue;
+                        }
                     }
-                    q.push(new_c);
+                    children.push_back(new_c);
                 }
+                q->push_children(c, children);
             }
         }
+
+        if (result.interaction_detected) {
+            break;
+        }
     }
+    result.num_iters = iter;
+
+    if (result.interaction_detected) {
+        std::cout << "Search interferes with excluded edges. Aborting." << std::endl;
+        return result;
+    }
+
     std::cout << "Branch-and-bound optimization completed." << std::endl;
     result.insertion_sequence = best_insertion_sequence;
-    result.num_iters = iter;
+    result.upper_bound = global_upper_bound;
 
     {
-        // Drain the rest of the queue to find the maximum optimality gap
-        auto final_lower_bound = std::numeric_limits<double>::infinity();
-        auto final_gap = 1.0;
-        while (!q.empty()) {
-            auto c = q.top();
-            final_lower_bound = std::min(final_lower_bound, c.lower_bound);
-            final_gap = 1.0 - final_lower_bound / global_upper_bound;
-            q.pop();
-        }
+        // Use the rest of the queue to find the maximum optimality gap
+        auto final_lower_bound = q->min_lower_bound();
+        auto final_gap = 1.0 - final_lower_bound / global_upper_bound;
         if (std::isinf(final_lower_bound)) {
             final_lower_bound = global_upper_bound * (1.0 - _settings.optimality_gap);
             final_gap = _settings.optimality_gap;
@@ -385,6 +574,303 @@ BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettin
         result.gap = final_gap;
     }
 
+    return result;
+}
+
+/// Groups the conflicting edges of _es into components that can be resolved independently of each other.
+/// Two edges end up in the same component if they are (transitively) in conflict
+/// or if they share a layout vertex, since inserting one of them changes the sectors available to the other.
+std::vector<std::set<pm::edge_index>> independent_conflict_components(const EmbeddingState& _es)
+{
+    const pm::Mesh& l_m = _es.em.layout_mesh();
+    const auto conflicting_edges = _es.conflicting_edges();
+
+    UnionFind l_e_components(l_m.edges().size());
+    for (const auto& [l_ei_A, l_ei_B] : _es.conflicts) {
+        l_e_components.merge(l_ei_A.value, l_ei_B.value);
+    }
+    for (const auto l_v : l_m.vertices()) {
+        int l_ei_first = -1;
+        for (const auto l_e : l_v.edges()) {
+            if (conflicting_edges.count(l_e)) {
+                if (l_ei_first < 0) {
+                    l_ei_first = l_e.idx.value;
+                }
+                else {
+                    l_e_components.merge(l_ei_first, l_e.idx.value);
+                }
+            }
+        }
+    }
+
+    std::map<int, std::set<pm::edge_index>> components;
+    for (const auto& l_ei : conflicting_edges) {
+        components[l_e_components.representative(l_ei.value)].insert(l_ei);
+    }
+
+    std::vector<std::set<pm::edge_index>> result;
+    for (const auto& [representative, component] : components) {
+        result.push_back(component);
+    }
+    return result;
+}
+
+/// Restricts the incumbent solution _insertion_sequence to the edges of one conflict component:
+/// Replays its insertions of edges in _component on _root, in the same order.
+/// If this leaves no conflict involving a non-excluded edge, it is a solution of the sub-problem,
+/// and its cost (total cost of the layout, like the sub-search reports it) is returned.
+/// Returns infinity otherwise.
+double restricted_incumbent(
+        const EmbeddingState& _root,
+        const BranchAndBoundSettings& _settings,
+        const std::set<pm::edge_index>& _component,
+        const std::set<pm::edge_index>& _excluded_edges,
+        const InsertionSequence& _insertion_sequence,
+        InsertionSequence& _restricted_insertion_sequence)
+{
+    _restricted_insertion_sequence.clear();
+
+    EmbeddingState es(_root.em, _settings);
+    for (const auto& l_ei : _insertion_sequence) {
+        if (!_component.count(l_ei) || es.em.is_embedded(l_ei)) {
+            continue;
+        }
+        const auto path = es.em.find_shortest_path(es.em.layout_mesh().edges()[l_ei].halfedgeA());
+        if (path.empty()) {
+            return std::numeric_limits<double>::infinity();
+        }
+        es.extend(l_ei, path);
+        _restricted_insertion_sequence.push_back(l_ei);
+    }
+    es.compute_all_candidate_paths();
+    es.detect_candidate_path_conflicts();
+    if (!es.valid()) {
+        return std::numeric_limits<double>::infinity();
+    }
+
+    for (const auto& [l_ei_A, l_ei_B] : es.conflicts) {
+        if (!_excluded_edges.count(l_ei_A) || !_excluded_edges.count(l_ei_B)) {
+            return std::numeric_limits<double>::infinity();
+        }
+    }
+
+    return es.cost_lower_bound();
+}
+
+/// Solves each conflict component as a separate search and combines the results.
+/// Each sub-search starts with the incumbent solution restricted to its component (if that is feasible).
+/// The combined solution is verified on the full layout. Returns false if the components
+/// turned out to interact (or if a component could not be solved), true otherwise.
+/// Components are only independent w.r.t. the conflicts of the root state, and the verification
+/// only confirms the upper bound. The reported lower bound therefore remains the one of the root state.
+bool search_decomposed(
+        const EmbeddingState& _root,
+        const std::vector<std::set<pm::edge_index>>& _components,
+        const BranchAndBoundSettings& _settings,
+        const InsertionSequence& _incumbent_insertion_sequence,
+        const glow::timing::CpuTimer& _timer,
+        SearchResult& _result)
+{
+    // Each sub-problem reports the total cost of the layout,
+    // with all other components remaining at their root candidate paths.
+    const double root_lower_bound = _root.cost_lower_bound();
+
+    SearchResult combined;
+    combined.upper_bound = root_lower_bound;
+
+    // Even if decomposition fails, report the effort spent on it.
+    auto fail = [&]() {
+        _result.num_iters = combined.num_iters;
+        _result.num_traced_paths = combined.num_traced_paths;
+        _result.max_state_tree_memory_estimate = combined.max_state_tree_memory_estimate;
+        return false;
+    };
+
+    for (std::size_t i = 0; i < _components.size(); ++i) {
+        std::set<pm::edge_index> excluded_edges;
+        for (std::size_t j = 0; j < _components.size(); ++j) {
+            if (j != i) {
+                excluded_edges.insert(_components[j].begin(), _components[j].end());
+            }
+        }
+
+        InsertionSequence incumbent_insertion_sequence;
+        double incumbent_cost = std::numeric_limits<double>::infinity();
+        if (!_incumbent_insertion_sequence.empty()) {
+            incumbent_cost = restricted_incumbent(_root, _settings, _components[i], excluded_edges, _incumbent_insertion_sequence, incumbent_insertion_sequence);
+        }
+
+        std::cout << "Solving conflict component " << (i + 1) << " of " << _components.size() << " (" << _components[i].size() << " edges)";
+        if (!std::isinf(incumbent_cost)) {
+            std::cout << ", incumbent cost " << incumbent_cost;
+        }
+        std::cout << std::endl;
+        const auto sub_result = search(_root, _settings, excluded_edges, incumbent_cost, incumbent_insertion_sequence, _timer, nullptr);
+
+        combined.num_iters += sub_result.num_iters;
+        combined.num_traced_paths += sub_result.num_traced_paths;
+        combined.max_state_tree_memory_estimate = std::max(combined.max_state_tree_memory_estimate, sub_result.max_state_tree_memory_estimate);
+
+        if (sub_result.interaction_detected || std::isinf(sub_result.upper_bound)) {
+            return fail();
+        }
+
+        combined.upper_bound += sub_result.upper_bound - root_lower_bound;
+        combined.insertion_sequence.insert(combined.insertion_sequence.end(), sub_result.insertion_sequence.begin(), sub_result.insertion_sequence.end());
+    }
+
+    // Replay the combined insertion sequence on the full layout.
+    // It is only accepted if it leaves no conflicts and reproduces the predicted cost.
+    EmbeddingState es(_root.em, _settings);
+    for (const auto& l_ei : combined.insertion_sequence) {
+        const auto l_he = es.em.layout_mesh().edges()[l_ei].halfedgeA();
+        const auto path = es.em.find_shortest_path(l_he);
+        if (path.empty()) {
+            return fail();
+        }
+        es.extend(l_ei, path);
+    }
+    es.compute_all_candidate_paths();
+    es.detect_candidate_path_conflicts();
+    if (!es.valid() || !es.conflicts.empty()) {
+        return fail();
+    }
+
+    const double cost = es.cost_lower_bound();
+    if (std::abs(cost - combined.upper_bound) > 1e-6 * combined.upper_bound) {
+        return fail();
+    }
+
+    combined.upper_bound = cost;
+    combined.lower_bound = std::min(root_lower_bound, cost);
+    combined.gap = 1.0 - combined.lower_bound / combined.upper_bound;
+    _result = combined;
+
+    return true;
+}
+
+}
+
+BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettings& _settings, const std::string& _name)
+{
+    glow::timing::CpuTimer timer;
+
+    BranchAndBoundResult result(_name, _settings);
+
+    InsertionSequence best_insertion_sequence;
+    double global_upper_bound = std::numeric_limits<double>::infinity();
+
+    if (_settings.record_lower_bound_events) {
+        BranchAndBoundResult::LowerBoundEvent event;
+        event.t = 0.0;
+        event.lower_bound = 0.0;
+        result.lower_bound_events.push_back(event);
+    }
+
+    if (_settings.record_upper_bound_events) {
+        BranchAndBoundResult::UpperBoundEvent event;
+        event.t = 0.0;
+        event.upper_bound = std::numeric_limits<double>::infinity();
+        result.upper_bound_events.push_back(event);
+    }
+
+    // Run heuristic algorithm to find a tighter initial upper bound.
+    if (_settings.use_greedy_init) {
+        Embedding em(_em);
+        const auto results = embed_competitors(em);
+        global_upper_bound = em.total_embedded_path_length();
+        best_insertion_sequence = best(results).insertion_sequence;
+
+        if (_settings.greedy_init_random_restarts > 0) {
+            Embedding em_randomized(_em);
+            const auto randomized_results = embed_randomized(em_randomized, _settings.greedy_init_random_restarts);
+            if (best(randomized_results).cost < global_upper_bound) {
+                global_upper_bound = em_randomized.total_embedded_path_length();
+                best_insertion_sequence = best(randomized_results).insertion_sequence;
+            }
+        }
+
+        if (_settings.record_upper_bound_events) {
+            BranchAndBoundResult::UpperBoundEvent event;
+            event.t = timer.elapsedSecondsD();
+            event.upper_bound = global_upper_bound;
+            result.upper_bound_events.push_back(event);
+        }
+    }
+
+    EmbeddingState root(_em, _settings);
+    root.compute_all_candidate_paths();
+    root.detect_candidate_path_conflicts();
+
+    SearchResult search_result;
+    bool solved = false;
+    double t_decomposition = 0.0;
+
+    // Try to split the problem into independent sub-problems.
+    if (_settings.use_conflict_decomposition && _settings.use_proactive_pruning && root.valid()) {
+        const auto components = independent_conflict_components(root);
+        if (components.size() >= 2) {
+            std::cout << "Found " << components.size() << " independent conflict components." << std::endl;
+            const double t_decomposition_start = timer.elapsedSecondsD();
+            solved = search_decomposed(root, components, _settings, best_insertion_sequence, timer, search_result);
+            t_decomposition = timer.elapsedSecondsD() - t_decomposition_start;
+            if (solved) {
+                std::cout << "Combined solution of conflict components: " << search_result.upper_bound << std::endl;
+                if (search_result.upper_bound < global_upper_bound) {
+                    global_upper_bound = search_result.upper_bound;
+                    best_insertion_sequence = search_result.insertion_sequence;
+                    if (_settings.record_upper_bound_events) {
+                        BranchAndBoundResult::UpperBoundEvent event;
+                        event.t = timer.elapsedSecondsD();
+                        event.upper_bound = global_upper_bound;
+                        event.num_iters = search_result.num_iters;
+                        result.upper_bound_events.push_back(event);
+                    }
+                }
+                if (_settings.record_lower_bound_events) {
+                    BranchAndBoundResult::LowerBoundEvent event;
+                    event.t = timer.elapsedSecondsD();
+                    event.lower_bound = std::min(search_result.lower_bound, global_upper_bound);
+                    result.lower_bound_events.push_back(event);
+                }
+                search_result.insertion_sequence = best_insertion_sequence;
+                search_result.upper_bound = global_upper_bound;
+                search_result.gap = 1.0 - search_result.lower_bound / global_upper_bound;
+            }
+            else {
+                std::cout << "Conflict components interact. Falling back to a joint search." << std::endl;
+            }
+        }
+    }
+
+    if (!solved) {
+        const int num_iters_decomposed = search_result.num_iters;
+        const int num_traced_paths_decomposed = search_result.num_traced_paths;
+        const double memory_decomposed = search_result.max_state_tree_memory_estimate;
+
+        // The joint search gets the full time budget, regardless of the time spent on a failed decomposition
+        BranchAndBoundSettings joint_settings = _settings;
+        if (joint_settings.time_limit > 0.0) {
+            joint_settings.time_limit += t_decomposition;
+        }
+
+        search_result = search(root, joint_settings, {}, global_upper_bound, best_insertion_sequence, timer, &result);
+
+        search_result.num_iters += num_iters_decomposed;
+        search_result.num_traced_paths += num_traced_paths_decomposed;
+        search_result.max_state_tree_memory_estimate = std::max(search_result.max_state_tree_memory_estimate, memory_decomposed);
+    }
+
+    best_insertion_sequence = search_result.insertion_sequence;
+    global_upper_bound = search_result.upper_bound;
+
+    result.insertion_sequence = best_insertion_sequence;
+    result.num_iters = search_result.num_iters;
+    result.num_traced_paths = search_result.num_traced_paths;
+    result.max_state_tree_memory_estimate = search_result.max_state_tree_memory_estimate;
+    result.lower_bound = search_result.lower_bound;
+    result.gap = search_result.gap;
+
     if (std::isinf(global_upper_bound)) {
         result.cost = global_upper_bound;
         result.insertion_sequence.clear();
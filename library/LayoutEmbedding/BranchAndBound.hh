@@ -21,14 +21,55 @@ struct BranchAndBoundSettings
     };
     Priority priority = Priority::LowerBoundNonConflicting;
 
+    enum class NodeSelection
+    {
+        BestFirst,          // Always expand the node with the best priority
+        DepthFirstPlunging, // Best-first, but every plunge_period-th node is followed depth-first along its best children
+        LimitedDiscrepancy, // First explore nodes that deviate at most max_discrepancy times from the best child, then best-first
+    };
+    NodeSelection node_selection = NodeSelection::BestFirst;
+    int plunge_period = 10;
+    int max_discrepancy = 2;
+
+    // Greedily complete every n-th expanded node to find upper bounds early. Set to <= 0 to disable.
+    int greedy_completion_period = 0;
+
     bool use_state_hashing = true;
     bool use_proactive_pruning = true;
     bool use_candidate_paths_for_lower_bounds = true;
 
+    // Order the queue by an estimate of the cost of resolving candidate path conflicts.
+    // For each conflicting pair, one path is re-routed around the other candidate path,
+    // and the cheaper increases are summed over a matching of the conflict graph.
+    // The estimate assumes that one path of each pair keeps its candidate route. If both paths move,
+    // the increase can be arbitrarily small, so this is not a lower bound:
+    // It only affects the node priority, never pruning. Costs two path traces per conflict.
+    bool use_conflict_aware_priority = false;
+
+    // Push children as light descriptors (parent, inserted edge, optimistic bound)
+    // and only trace their candidate paths once they are selected for expansion.
+    // Materializing a child reconstructs its parent state once more, so this only pays off
+    // if enough children are pruned before they are selected (compare BranchAndBoundResult::num_traced_paths).
+    bool use_lazy_child_materialization = false;
+
+    // Keep the conflict sentinel of a state while it is being modified and only re-insert the paths that changed,
+    // instead of rebuilding it for every conflict detection.
+    // The sentinel is not stored with queued states: Restoring a state (EmbeddingState::set_candidate_paths()) discards it.
+    // It is built once per expanded node and copied into each eagerly created child, and it is kept during greedy completion.
+    // With use_lazy_child_materialization, each materialized child rebuilds it, so only greedy completion benefits.
+    bool use_incremental_conflict_detection = true;
+
+    // Solve groups of conflicting edges that do not interact (no shared conflicts, no shared layout vertices)
+    // as separate sub-problems and combine their solutions. Requires use_proactive_pruning.
+    // Falls back to a joint search (with its own time budget) if the groups turn out to interact.
+    // Independence is a heuristic w.r.t. the root conflicts, so a combined solution keeps the root lower bound.
+    bool use_conflict_decomposition = false;
+
     bool print_current_insertion_sequence = true;
     bool print_memory_footprint_estimate = true;
 
     bool use_greedy_init = true;
+    int greedy_init_random_restarts = 0; // If > 0, additionally run randomized greedy restarts (see embed_randomized())
 };
 
 struct BranchAndBoundResult
@@ -53,6 +94,7 @@ struct BranchAndBoundResult
     {
         double t;
         double upper_bound;
+        int num_iters = 0; // Expanded nodes when the upper bound was found
     };
     std::vector<UpperBoundEvent> upper_bound_events;
 
@@ -65,6 +107,7 @@ struct BranchAndBoundResult
 
     double max_state_tree_memory_estimate = 0.0; // Bytes
     int num_iters = 0;
+    int num_traced_paths = 0; // Candidate paths re-traced while creating child states
 };
 
 BranchAndBoundResult branch_and_bound(Embedding& _em, const BranchAndBoundSettings& _settings = BranchAndBoundSettings(), const std::string& _name = "bnb");
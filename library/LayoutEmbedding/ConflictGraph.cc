@@ -0,0 +1,65 @@
+#include "ConflictGraph.hh"
+
+#include <LayoutEmbedding/Util/Assert.hh>
+
+#include <algorithm>
+
+namespace LayoutEmbedding {
+
+ConflictGraph::ConflictGraph(const std::vector<Conflict>& _pairs)
+{
+    for (const auto& [a, b] : _pairs) {
+        insert(a, b);
+    }
+}
+
+bool ConflictGraph::insert(const Label& _a, const Label& _b)
+{
+    if (_a == _b) {
+        return false;
+    }
+
+    const Conflict sorted = std::minmax(_a, _b);
+    const auto it = std::lower_bound(conflicts.begin(), conflicts.end(), sorted);
+    if (it != conflicts.end() && *it == sorted) {
+        return false;
+    }
+    conflicts.insert(it, sorted);
+
+    const int max_label = sorted.second.value;
+    if (max_label >= (int)adjacency.size()) {
+        adjacency.resize(max_label + 1);
+    }
+    adjacency[sorted.first.value].push_back(sorted.second);
+    adjacency[sorted.second.value].push_back(sorted.first);
+    return true;
+}
+
+bool ConflictGraph::contains(const Label& _a, const Label& _b) const
+{
+    const auto& n = neighbors(_a);
+    return std::find(n.begin(), n.end(), _b) != n.end();
+}
+
+void ConflictGraph::clear()
+{
+    conflicts.clear();
+    adjacency.clear();
+}
+
+const std::vector<ConflictGraph::Label>& ConflictGraph::neighbors(const Label& _l) const
+{
+    static const std::vector<Label> none;
+    LE_ASSERT_GEQ(_l.value, 0);
+    if (_l.value >= (int)adjacency.size()) {
+        return none;
+    }
+    return adjacency[_l.value];
+}
+
+int ConflictGraph::degree(const Label& _l) const
+{
+    return neighbors(_l).size();
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <polymesh/pm.hh>
+
+#include <utility>
+#include <vector>
+
+namespace LayoutEmbedding {
+
+/// Symmetric conflict relation among layout edges.
+/// Keeps a sorted list of pairs (compact to copy and compare) and per-edge neighbor lists for O(degree) queries.
+class ConflictGraph
+{
+public:
+    using Label = pm::edge_index;
+    using Conflict = std::pair<Label, Label>; // first < second
+
+    ConflictGraph() = default;
+    explicit ConflictGraph(const std::vector<Conflict>& _pairs);
+
+    /// Returns false if the pair was already contained. Self-conflicts are ignored.
+    bool insert(const Label& _a, const Label& _b);
+    bool contains(const Label& _a, const Label& _b) const;
+    void clear();
+
+    /// Labels in conflict with _l.
+    const std::vector<Label>& neighbors(const Label& _l) const;
+    int degree(const Label& _l) const;
+
+    bool empty() const { return conflicts.empty(); }
+    std::size_t size() const { return conflicts.size(); }
+
+    /// All pairs in lexicographic order.
+    const std::vector<Conflict>& pairs() const { return conflicts; }
+    std::vector<Conflict>::const_iterator begin() const { return conflicts.begin(); }
+    std::vector<Conflict>::const_iterator end() const { return conflicts.end(); }
+
+    bool operator==(const ConflictGraph& _rhs) const { return conflicts == _rhs.conflicts; }
+    bool operator!=(const ConflictGraph& _rhs) const { return conflicts != _rhs.conflicts; }
+
+private:
+    std::vector<Conflict> conflicts;
+    std::vector<std::vector<Label>> adjacency; // Indexed by label, only as large as the largest conflicting label
+};
+
+}
@@ -39,9 +39,23 @@ Embedding::Embedding(const Embedding& _em)
     *this = _em;
 }
 
+Embedding::Embedding(const Embedding& _em, EmbeddingInput& _input)
+{
+    copy_from(_em, &_input);
+}
+
 Embedding& Embedding::operator=(const Embedding& _em)
 {
-    input = _em.input;
+    copy_from(_em, _em.input);
+    return *this;
+}
+
+void Embedding::copy_from(const Embedding& _em, EmbeddingInput* _input)
+{
+    LE_ASSERT_EQ(_input->l_m.vertices().size(), _em.layout_mesh().vertices().size());
+    LE_ASSERT_EQ(_input->l_m.halfedges().size(), _em.layout_mesh().halfedges().size());
+
+    input = _input;
     t_m.copy_from(_em.t_m);
 
     t_pos = t_m.vertices().make_attribute<tg::pos3>();
@@ -62,12 +76,9 @@ Embedding& Embedding::operator=(const Embedding& _em)
         t_matching_halfedge[t_he] = layout_mesh()[_em.t_matching_halfedge[t_he.idx].idx];
     }
 
-    if (_em.vertex_repulsive_energy.has_value()) {
-        vertex_repulsive_energy = target_mesh().vertices().make_attribute<Eigen::VectorXd>();
-        vertex_repulsive_energy->copy_from(*_em.vertex_repulsive_energy);
-    }
-
-    return *this;
+    vertex_repulsive_energy = _em.vertex_repulsive_energy;
+    t_split_parents = _em.t_split_parents;
+    t_split_energy = _em.t_split_energy;
 }
 
 pm::halfedge_handle Embedding::get_embedded_target_halfedge(const pm::halfedge_handle& _l_he) const
@@ -266,7 +277,41 @@ tg::pos3 Embedding::element_pos(const VirtualVertex& _t_vv) const
     }
 }
 
-VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _t_h_sector_start, const pm::halfedge_handle& _t_h_sector_end, ShortestPathMetric _metric) const
+Embedding::PathObstacle Embedding::path_obstacle(const VirtualPath& _path) const
+{
+    PathObstacle obstacle;
+    for (int i = 0; i < (int)_path.size(); ++i) {
+        const auto& vv = _path[i];
+        if (is_real_vertex(vv)) {
+            if (i > 0 && i < (int)_path.size() - 1) {
+                obstacle.vertices.insert(real_vertex(vv).value);
+            }
+        }
+        else {
+            obstacle.edges.insert(real_edge(vv).value);
+        }
+    }
+    for (int i = 0; i < (int)_path.size() - 1; ++i) {
+        const auto& vv0 = _path[i];
+        const auto& vv1 = _path[i + 1];
+        if (is_real_vertex(vv0) && is_real_vertex(vv1)) {
+            const auto t_h = pm::halfedge_from_to(real_vertex(vv0, target_mesh()), real_vertex(vv1, target_mesh()));
+            obstacle.edges.insert(t_h.edge().idx.value);
+        }
+        else if (is_real_vertex(vv0)) {
+            obstacle.faces.insert(triangle_with_edge_and_opposite_vertex(real_edge(vv1, target_mesh()), real_vertex(vv0, target_mesh())).idx.value);
+        }
+        else if (is_real_vertex(vv1)) {
+            obstacle.faces.insert(triangle_with_edge_and_opposite_vertex(real_edge(vv0, target_mesh()), real_vertex(vv1, target_mesh())).idx.value);
+        }
+        else {
+            obstacle.faces.insert(common_face(real_edge(vv0, target_mesh()), real_edge(vv1, target_mesh())).idx.value);
+        }
+    }
+    return obstacle;
+}
+
+VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _t_h_sector_start, const pm::halfedge_handle& _t_h_sector_end, ShortestPathMetric _metric, const PathObstacle* _obstacle) const
 {
     struct Distance
     {
@@ -304,6 +349,12 @@ VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _t_h_sector
     const VirtualVertex vv_start(t_v_start);
     const VirtualVertex vv_end(t_v_end);
 
+    if (_metric == ShortestPathMetric::VertexRepulsive) {
+        // Solve the two required fields up front (in parallel)
+        init_vertex_repulsive_energy();
+        vertex_repulsive_energy->require({matching_layout_vertex(t_v_start).idx.value, matching_layout_vertex(t_v_end).idx.value});
+    }
+
     auto get_virtual_vertices_in_sector = [&](const pm::halfedge_handle& t_he_sector) {
         auto t_he_sector_start = t_he_sector;
         auto t_he_sector_end = t_he_sector;
@@ -357,7 +408,39 @@ VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _t_h_sector
         q.push(c);
     }
 
+    // Does the step touch or cross the obstacle?
+    auto blocked_by_obstacle = [&](const VirtualVertex& from, const VirtualVertex& to) {
+        if (is_real_vertex(to)) {
+            if (_obstacle->vertices.count(real_vertex(to).value)) {
+                return true;
+            }
+        }
+        else if (_obstacle->edges.count(real_edge(to).value)) {
+            return true;
+        }
+
+        if (is_real_vertex(from) && is_real_vertex(to)) {
+            const auto t_h = pm::halfedge_from_to(real_vertex(from, target_mesh()), real_vertex(to, target_mesh()));
+            return _obstacle->edges.count(t_h.edge().idx.value) > 0;
+        }
+        pm::face_handle t_f;
+        if (is_real_vertex(from)) {
+            t_f = triangle_with_edge_and_opposite_vertex(real_edge(to, target_mesh()), real_vertex(from, target_mesh()));
+        }
+        else if (is_real_vertex(to)) {
+            t_f = triangle_with_edge_and_opposite_vertex(real_edge(from, target_mesh()), real_vertex(to, target_mesh()));
+        }
+        else {
+            t_f = common_face(real_edge(from, target_mesh()), real_edge(to, target_mesh()));
+        }
+        return _obstacle->faces.count(t_f.idx.value) > 0;
+    };
+
     auto legal_step = [&](const VirtualVertex& from, const VirtualVertex& to) {
+        if (_obstacle && blocked_by_obstacle(from, to)) {
+            return false;
+        }
+
         if (from == vv_start) {
             if (std::find(legal_first_vvs.cbegin(), legal_first_vvs.cend(), to) == legal_first_vvs.cend()) {
                 return false;
@@ -494,14 +577,14 @@ VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _t_h_sector
     }
 }
 
-VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _l_he, ShortestPathMetric _metric) const
+VirtualPath Embedding::find_shortest_path(const pm::halfedge_handle& _l_he, ShortestPathMetric _metric, const PathObstacle* _obstacle) const
 {
     LE_ASSERT(_l_he.mesh == &layout_mesh());
     LE_ASSERT(!is_embedded(_l_he));
     const auto l_he_end = _l_he.opposite();
     const auto t_he_sector_start = get_embeddable_sector(_l_he);
     const auto t_he_sector_end = get_embeddable_sector(l_he_end);
-    return find_shortest_path(t_he_sector_start, t_he_sector_end, _metric);
+    return find_shortest_path(t_he_sector_start, t_he_sector_end, _metric, _obstacle);
 }
 
 VirtualPath Embedding::find_shortest_path(const pm::edge_handle& _l_e, ShortestPathMetric _metric) const
@@ -542,12 +625,15 @@ void Embedding::embed_path(const pm::halfedge_handle& _l_he, const VirtualPath&
             const auto& p1 = t_pos[t_vB];
             const auto p = tg::mix(p0, p1, 0.5);
 
+            // Only record the split if all previous ones were recorded
+            const bool record_split = vertex_repulsive_energy && vertex_repulsive_energy_covers_target_mesh();
+
             const auto t_v_new = target_mesh().edges().split_and_triangulate(t_e);
             t_pos[t_v_new] = p;
 
-            if (vertex_repulsive_energy.has_value()) {
-                Eigen::VectorXd vre = 0.5 * (*vertex_repulsive_energy)[t_vA] + 0.5 * (*vertex_repulsive_energy)[t_vB];
-                (*vertex_repulsive_energy)[t_v_new] = vre;
+            if (record_split) {
+                LE_ASSERT_EQ(t_v_new.idx.value, vertex_repulsive_energy->num_target_vertices() + (int)t_split_parents.size());
+                t_split_parents.push_back({t_vA.idx.value, t_vB.idx.value});
             }
 
             vertex_path.push_back(t_v_new);
@@ -716,6 +802,11 @@ bool Embedding::is_complete() const
     return true;
 }
 
+EmbeddingInput& Embedding::get_input()
+{
+    return *input;
+}
+
 const pm::Mesh& Embedding::layout_mesh() const
 {
     return input->l_m;
@@ -798,15 +889,61 @@ double Embedding::get_vertex_repulsive_energy(const pm::vertex_handle& _t_v, con
     LE_ASSERT(_t_v.mesh == &target_mesh());
     LE_ASSERT(_l_v.mesh == &layout_mesh());
 
-    if (!vertex_repulsive_energy.has_value()) {
-        Eigen::MatrixXd vre = compute_vertex_repulsive_energy(*this);
-        vertex_repulsive_energy = target_mesh().vertices().make_attribute<Eigen::VectorXd>();
-        for (const auto t_v : target_mesh().vertices()) {
-            (*vertex_repulsive_energy)[t_v] = vre.row(t_v.idx.value);
-        }
+    init_vertex_repulsive_energy();
+    vertex_repulsive_energy->require(_l_v.idx.value);
+    return vertex_repulsive_energy_at(_t_v.idx.value, _l_v.idx.value);
+}
+
+void Embedding::reset_vertex_repulsive_energy()
+{
+    vertex_repulsive_energy.reset();
+    t_split_parents.clear();
+    t_split_energy.clear();
+}
+
+bool Embedding::vertex_repulsive_energy_covers_target_mesh() const
+{
+    LE_ASSERT(vertex_repulsive_energy);
+    return (int)target_mesh().vertices().size() == vertex_repulsive_energy->num_target_vertices() + (int)t_split_parents.size();
+}
+
+void Embedding::init_vertex_repulsive_energy() const
+{
+    // The target mesh was refined without recording the splits
+    if (vertex_repulsive_energy && !vertex_repulsive_energy_covers_target_mesh()) {
+        vertex_repulsive_energy.reset();
+        t_split_parents.clear();
+        t_split_energy.clear();
+    }
+
+    if (!vertex_repulsive_energy) {
+        LE_ASSERT(t_split_parents.empty());
+        vertex_repulsive_energy = std::make_shared<VertexRepulsiveEnergy>(*this);
+    }
+}
+
+double Embedding::vertex_repulsive_energy_at(int _t_vi, int _l_vi) const
+{
+    const int t_num_v = vertex_repulsive_energy->num_target_vertices();
+    if (_t_vi < t_num_v) {
+        return vertex_repulsive_energy->field(_l_vi)[_t_vi];
+    }
+
+    // Split vertices are created after their parents, so the cached values can be extended in index order.
+    // This avoids recursing through chains of splits, which visits up to 2^depth ancestors.
+    if ((int)t_split_energy.size() <= _l_vi) {
+        t_split_energy.resize(_l_vi + 1);
+    }
+    auto& split_energy = t_split_energy[_l_vi];
+    const auto field = vertex_repulsive_energy->field(_l_vi);
+    auto energy_at = [&](int _t_vi_parent) {
+        return _t_vi_parent < t_num_v ? field[_t_vi_parent] : split_energy[_t_vi_parent - t_num_v];
+    };
+    while ((int)split_energy.size() <= _t_vi - t_num_v) {
+        const auto& [t_vi_A, t_vi_B] = t_split_parents[split_energy.size()];
+        split_energy.push_back(0.5 * energy_at(t_vi_A) + 0.5 * energy_at(t_vi_B));
     }
-    LE_ASSERT(vertex_repulsive_energy.has_value());
-    return (*vertex_repulsive_energy)[_t_v][_l_v.idx.value];
+    return split_energy[_t_vi - t_num_v];
 }
 
 double Embedding::get_vertex_repulsive_energy(const VirtualVertex& _t_vv, const pm::vertex_handle& _l_v) const
@@ -8,11 +8,14 @@
 
 #include <Eigen/Dense>
 
+#include <memory>
 #include <optional>
+#include <unordered_set>
 
 namespace LayoutEmbedding {
 
 struct Snake;
+class VertexRepulsiveEnergy;
 
 class Embedding
 {
@@ -22,6 +25,10 @@ public:
     Embedding(const Embedding& _em);
     Embedding& operator=(const Embedding& _em);
 
+    /// Copies _em, but refers to the layout mesh of _input, which must be a copy of the input of _em.
+    /// Embeddings on separate inputs share no mesh and can be modified concurrently.
+    Embedding(const Embedding& _em, EmbeddingInput& _input);
+
     /// If the layout halfedge _l_h has an embedding, returns the target halfedge at the start of the corresponding embedded path.
     /// Otherwise, returns an invalid halfedge.
     pm::halfedge_handle get_embedded_target_halfedge(const pm::halfedge_handle& _l_he) const;
@@ -48,14 +55,27 @@ public:
         VertexRepulsive,
     };
 
+    /// Target elements of an unembedded (virtual) path, which another path may neither touch nor cross.
+    /// Allows tracing around a path without embedding it, i.e. without copying and refining the target mesh.
+    /// Conservative: Faces the path passes through are blocked entirely.
+    struct PathObstacle
+    {
+        std::unordered_set<int> vertices; // Interior vertices of the path
+        std::unordered_set<int> edges;    // Edges crossed at their midpoint or followed by the path
+        std::unordered_set<int> faces;    // Faces the path passes through
+    };
+    PathObstacle path_obstacle(const VirtualPath& _path) const;
+
     VirtualPath find_shortest_path(
         const pm::halfedge_handle& _t_h_sector_start, // Target halfedge, at the beginning of a sector
         const pm::halfedge_handle& _t_h_sector_end,   // Target halfedge, at the beginning of a sector
-        ShortestPathMetric _metric = ShortestPathMetric::Geodesic
+        ShortestPathMetric _metric = ShortestPathMetric::Geodesic,
+        const PathObstacle* _obstacle = nullptr
     ) const;
     VirtualPath find_shortest_path(
         const pm::halfedge_handle& _l_he, // Layout halfedge
-        ShortestPathMetric _metric = ShortestPathMetric::Geodesic
+        ShortestPathMetric _metric = ShortestPathMetric::Geodesic,
+        const PathObstacle* _obstacle = nullptr
     ) const;
     VirtualPath find_shortest_path(
         const pm::edge_handle& _l_e, // Layout edge
@@ -82,6 +102,7 @@ public:
     bool load(std::string filename);
 
     // Getters.
+    EmbeddingInput& get_input();
     const pm::Mesh& layout_mesh() const; // This will always refer to the original l_m in the input
     pm::Mesh& layout_mesh(); // This will always refer to the original l_m in the input
     const pm::vertex_attribute<tg::pos3>& layout_pos() const;
@@ -100,7 +121,12 @@ public:
     double get_vertex_repulsive_energy(const pm::vertex_handle& _t_v, const pm::vertex_handle& _l_v) const;
     double get_vertex_repulsive_energy(const VirtualVertex& _t_vv, const pm::vertex_handle& _l_v) const;
 
+    /// Discards the vertex repulsive energy cache. Required after removing target vertices.
+    void reset_vertex_repulsive_energy();
+
 private:
+    void copy_from(const Embedding& _em, EmbeddingInput* _input);
+
     EmbeddingInput* input;
     pm::Mesh t_m; // Target mesh. Copy.
     pm::vertex_attribute<tg::pos3> t_pos; // Target mesh positions. Copy.
@@ -110,8 +136,15 @@ private:
     pm::halfedge_attribute<pm::halfedge_handle> t_matching_halfedge;
 
     // Cache for the energy used for vertex repulsive path tracing [Praun2001].
-    // Computed lazily when required. Access via get_vertex_repulsive_energy.
-    mutable std::optional<pm::vertex_attribute<Eigen::VectorXd>> vertex_repulsive_energy;
+    // Computed lazily when required (per layout vertex), shared between copies. Access via get_vertex_repulsive_energy.
+    // Target vertices created by later edge splits in embed_path(VirtualPath) interpolate the values of their parents.
+    // If the target mesh was modified otherwise (e.g. by embedding snakes or path smoothing), the fields are recomputed.
+    mutable std::shared_ptr<VertexRepulsiveEnergy> vertex_repulsive_energy;
+    mutable std::vector<std::pair<int, int>> t_split_parents; // Indexed by target vertex index - vertex_repulsive_energy->num_target_vertices()
+    mutable std::vector<std::vector<double>> t_split_energy; // Interpolated values per layout vertex, same indexing as t_split_parents
+    bool vertex_repulsive_energy_covers_target_mesh() const;
+    void init_vertex_repulsive_energy() const;
+    double vertex_repulsive_energy_at(int _t_vi, int _l_vi) const;
 };
 
 }
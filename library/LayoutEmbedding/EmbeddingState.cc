@@ -4,13 +4,29 @@
 #include <LayoutEmbedding/VirtualPathConflictSentinel.hh>
 #include <LayoutEmbedding/Util/Assert.hh>
 
+#include <algorithm>
+
 namespace LayoutEmbedding {
 
 EmbeddingState::EmbeddingState(const Embedding& _em, const BranchAndBoundSettings& _settings) :
     em(_em),
     candidate_paths(_em.layout_mesh()),
-    settings(&_settings)
+    settings(&_settings),
+    embedded_flags(_em.layout_mesh().edges().size(), false),
+    conflicting_flags(_em.layout_mesh().edges().size(), false),
+    candidate_lengths(_em.layout_mesh().edges().size(), 0.0)
 {
+    for (const auto l_e : em.layout_mesh().edges()) {
+        if (em.is_embedded(l_e)) {
+            embedded_flags[l_e.idx.value] = true;
+            ++num_embedded;
+        }
+        else {
+            candidate_lengths[l_e.idx.value] = std::numeric_limits<double>::infinity();
+            ++num_missing_candidates;
+        }
+    }
+    total_embedded_length = em.total_embedded_path_length();
 }
 
 void EmbeddingState::extend(const pm::edge_index& _l_ei, const VirtualPath& _path)
@@ -26,8 +42,24 @@ void EmbeddingState::extend(const pm::edge_index& _l_ei, const VirtualPath& _pat
     LE_ASSERT(real_vertex(_path.front()) == em.matching_target_vertex(l_he.vertex_from()));
     LE_ASSERT(real_vertex(_path.back())  == em.matching_target_vertex(l_he.vertex_to()));
 
+    // Embedded edge midpoints are placed where the virtual vertices were, so the length is preserved.
+    total_embedded_length += em.path_length(_path);
+
     em.embed_path(l_he, _path);
     insertion_sequence.push_back(_l_ei);
+    embedded_flags[_l_ei.value] = true;
+    ++num_embedded;
+    conflict_cost_increase = 0.0;
+    changed_labels.insert(_l_ei);
+
+    // The edge no longer contributes a candidate path
+    if (std::isinf(candidate_lengths[_l_ei.value])) {
+        --num_missing_candidates;
+    }
+    else {
+        total_candidate_length -= candidate_lengths[_l_ei.value];
+    }
+    candidate_lengths[_l_ei.value] = 0.0;
 }
 
 void EmbeddingState::compute_candidate_path(const pm::edge_index& _l_ei)
@@ -42,15 +74,76 @@ void EmbeddingState::compute_candidate_path(const pm::edge_index& _l_ei)
     auto path = c_em.find_shortest_path(l_he);
 
     candidate_paths[l_e] = path;
+    update_candidate_path_length(_l_ei);
+    conflict_cost_increase = 0.0;
+    changed_labels.insert(_l_ei);
+}
+
+void EmbeddingState::update_candidate_path_length(const pm::edge_index& _l_ei)
+{
+    LE_ASSERT(!embedded_flags[_l_ei.value]);
+
+    // Remove the old contribution
+    double& length = candidate_lengths[_l_ei.value];
+    if (std::isinf(length)) {
+        --num_missing_candidates;
+    }
+    else {
+        total_candidate_length -= length;
+    }
+
+    // Add the new one
+    const auto& path = candidate_paths[_l_ei];
+    if (path.empty()) {
+        length = std::numeric_limits<double>::infinity();
+        ++num_missing_candidates;
+    }
+    else {
+        length = em.path_length(path);
+        total_candidate_length += length;
+    }
+}
+
+void EmbeddingState::set_candidate_paths(const std::vector<VirtualPath>& _paths)
+{
+    LE_ASSERT_EQ(_paths.size(), em.layout_mesh().edges().size());
+
+    candidate_paths.clear();
+    total_candidate_length = 0.0;
+    num_missing_candidates = 0;
+    for (const auto l_e : em.layout_mesh().edges()) {
+        candidate_paths[l_e] = _paths[l_e.idx.value];
+        if (embedded_flags[l_e.idx.value]) {
+            candidate_lengths[l_e.idx.value] = 0.0;
+        }
+        else if (candidate_paths[l_e].empty()) {
+            candidate_lengths[l_e.idx.value] = std::numeric_limits<double>::infinity();
+            ++num_missing_candidates;
+        }
+        else {
+            candidate_lengths[l_e.idx.value] = em.path_length(candidate_paths[l_e]);
+            total_candidate_length += candidate_lengths[l_e.idx.value];
+        }
+    }
+    conflict_cost_increase = 0.0;
+
+    // All paths may have changed, so the next conflict detection rebuilds the sentinel
+    sentinel.reset();
+    changed_labels.clear();
+}
+
+double EmbeddingState::candidate_path_length(const pm::edge_index& _l_ei) const
+{
+    return candidate_lengths[_l_ei.value];
 }
 
 void EmbeddingState::compute_all_candidate_paths()
 {
     const Embedding& c_em = em; // We don't want to modify the embedding in this method.
 
-    candidate_paths.clear();
+    set_candidate_paths(std::vector<VirtualPath>(c_em.layout_mesh().edges().size()));
     for (const auto l_e : c_em.layout_mesh().edges()) {
-        if (!c_em.is_embedded(l_e)) {
+        if (!embedded_flags[l_e.idx.value]) {
             compute_candidate_path(l_e);
         }
     }
@@ -59,49 +152,131 @@ void EmbeddingState::compute_all_candidate_paths()
 void EmbeddingState::detect_candidate_path_conflicts()
 {
     const Embedding& c_em = em; // We don't want to modify the embedding in this method.
-    conflicts.clear();
+    set_conflicts(ConflictGraph());
 
-    if (valid()) {
-        VirtualPathConflictSentinel vpcs(c_em);
+    if (!valid()) {
+        sentinel.reset();
+    }
+    else if (sentinel.has_value() && settings->use_incremental_conflict_detection) {
+        // Only update the paths that changed since the last detection
+        if (sentinel->em != &c_em) {
+            sentinel->rebind(c_em);
+        }
+        // Remove all outdated paths before inserting any new one.
+        // Otherwise a new path would be checked against stale paths of labels that are processed later.
+        for (const auto& l_ei : changed_labels) {
+            if (sentinel->contains_path(l_ei)) {
+                sentinel->remove_path(l_ei);
+            }
+        }
+        for (const auto& l_ei : changed_labels) {
+            if (!embedded_flags[l_ei.value]) {
+                sentinel->insert_path(candidate_paths[l_ei], l_ei);
+            }
+        }
+        sentinel->check_path_ordering();
+        set_conflicts(sentinel->conflict_relation);
+    }
+    else {
+        sentinel.emplace(c_em);
         for (const auto l_e : c_em.layout_mesh().edges()) {
-            if (!c_em.is_embedded(l_e)) {
+            if (!embedded_flags[l_e.idx.value]) {
                 const auto& path = candidate_paths[l_e];
                 LE_ASSERT(!path.empty());
-                vpcs.insert_path(path, l_e);
+                sentinel->insert_path(path, l_e);
             }
         }
-        vpcs.check_path_ordering();
-        conflicts = vpcs.conflict_relation;
+        sentinel->check_path_ordering();
+        set_conflicts(sentinel->conflict_relation);
+    }
+    changed_labels.clear();
+
+    if (!settings->use_incremental_conflict_detection) {
+        sentinel.reset();
     }
 
-    LE_ASSERT_EQ(c_em.layout_mesh().edges().size(), embedded_edges().size() + conflicting_edges().size() + non_conflicting_edges().size());
+    conflict_cost_increase = 0.0;
+    if (settings->use_conflict_aware_priority && valid()) {
+        conflict_cost_increase = compute_conflict_cost_increase();
+    }
+
+    LE_ASSERT_EQ(c_em.layout_mesh().edges().size(), num_embedded_edges() + num_conflicting_edges() + num_non_conflicting_edges());
 }
 
-std::vector<pm::edge_index> EmbeddingState::get_conflicting_candidates(const pm::edge_index& _l_ei)
+void EmbeddingState::set_conflicts(const ConflictGraph& _conflicts)
 {
-    std::vector<pm::edge_index> result;
+    conflicts = _conflicts;
+
+    std::fill(conflicting_flags.begin(), conflicting_flags.end(), false);
+    num_conflicting = 0;
     for (const auto& [l_ei_A, l_ei_B] : conflicts) {
         LE_ASSERT(l_ei_A != l_ei_B);
-        if (_l_ei == l_ei_A) {
-            result.push_back(l_ei_B);
+        for (const auto& l_ei : {l_ei_A, l_ei_B}) {
+            if (!conflicting_flags[l_ei.value]) {
+                conflicting_flags[l_ei.value] = true;
+                ++num_conflicting;
+            }
         }
-        else if (_l_ei == l_ei_B) {
-            result.push_back(l_ei_A);
+    }
+}
+
+double EmbeddingState::compute_conflict_cost_increase() const
+{
+    if (conflicts.empty()) {
+        return 0.0;
+    }
+
+    // Length of each path when re-routed around the candidate path of a blocking edge.
+    // The blocking path is not embedded (which would require a copy of the refined target mesh),
+    // but traced around as an obstacle. Obstacle faces are blocked entirely, which can only lengthen the detour.
+    std::map<std::pair<pm::edge_index, pm::edge_index>, double> rerouted_length; // (rerouted, blocking) -> length
+    for (const auto& l_ei_blocking : conflicting_edges()) {
+        const auto obstacle = em.path_obstacle(candidate_paths[l_ei_blocking]);
+        for (const auto& l_ei_rerouted : conflicts.neighbors(l_ei_blocking)) {
+            const auto path = em.find_shortest_path(em.layout_mesh().edges()[l_ei_rerouted].halfedgeA(), Embedding::ShortestPathMetric::Geodesic, &obstacle);
+            rerouted_length[{l_ei_rerouted, l_ei_blocking}] = path.empty() ? std::numeric_limits<double>::infinity() : em.path_length(path);
+        }
+    }
+
+    // Cheapest increase per conflicting pair: re-route either one of the two paths
+    struct WeightedConflict
+    {
+        double increase;
+        pm::edge_index l_ei_A;
+        pm::edge_index l_ei_B;
+    };
+    std::vector<WeightedConflict> weighted_conflicts;
+    for (const auto& [l_ei_A, l_ei_B] : conflicts) {
+        const double increase_A = rerouted_length[{l_ei_A, l_ei_B}] - candidate_path_length(l_ei_A);
+        const double increase_B = rerouted_length[{l_ei_B, l_ei_A}] - candidate_path_length(l_ei_B);
+        weighted_conflicts.push_back({std::max(0.0, std::min(increase_A, increase_B)), l_ei_A, l_ei_B});
+    }
+
+    // Pairs that share no edge can be resolved independently, so their increases add up.
+    // Greedily build a heavy matching of the conflict graph.
+    std::sort(weighted_conflicts.begin(), weighted_conflicts.end(), [](const WeightedConflict& _a, const WeightedConflict& _b) {
+        return _a.increase > _b.increase;
+    });
+    std::set<pm::edge_index> matched;
+    double result = 0.0;
+    for (const auto& wc : weighted_conflicts) {
+        if (!matched.count(wc.l_ei_A) && !matched.count(wc.l_ei_B)) {
+            matched.insert(wc.l_ei_A);
+            matched.insert(wc.l_ei_B);
+            result += wc.increase;
         }
     }
     return result;
 }
 
+std::vector<pm::edge_index> EmbeddingState::get_conflicting_candidates(const pm::edge_index& _l_ei)
+{
+    return conflicts.neighbors(_l_ei);
+}
+
 bool EmbeddingState::valid() const
 {
-    for (const auto l_e : em.layout_mesh().edges()) {
-        if (!em.is_embedded(l_e)) {
-            if (candidate_paths[l_e].empty()) {
-                return false;
-            }
-        }
-    }
-    return true;
+    return num_missing_candidates == 0;
 }
 
 double EmbeddingState::cost_lower_bound() const
@@ -119,33 +294,29 @@ double EmbeddingState::cost_lower_bound() const
     }
 }
 
+double EmbeddingState::cost_estimate() const
+{
+    return cost_lower_bound() + conflict_cost_increase;
+}
+
 double EmbeddingState::embedded_cost() const
 {
-    return em.total_embedded_path_length();
+    return total_embedded_length;
 }
 
 double EmbeddingState::unembedded_cost() const
 {
-    double result = 0.0;
-    for (const auto l_e : em.layout_mesh().edges()) {
-        if (!em.is_embedded(l_e)) {
-            const auto& path = candidate_paths[l_e];
-            if (path.empty()) {
-                return std::numeric_limits<double>::infinity();
-            }
-            else {
-                result += em.path_length(path);
-            }
-        }
+    if (num_missing_candidates > 0) {
+        return std::numeric_limits<double>::infinity();
     }
-    return result;
+    return total_candidate_length;
 }
 
 HashValue EmbeddingState::hash() const
 {
     HashValue h = 0;
     for (const auto l_e : em.layout_mesh().edges()) {
-        if (em.is_embedded(l_e)) {
+        if (embedded_flags[l_e.idx.value]) {
             const auto& path = em.get_embedded_path(l_e.halfedgeA());
             for (const auto& t_v : path) {
                 const auto& pos = em.target_pos()[t_v];
@@ -164,9 +335,9 @@ HashValue EmbeddingState::hash() const
 std::set<pm::edge_index> EmbeddingState::embedded_edges() const
 {
     std::set<pm::edge_index> result;
-    for (const auto l_e : em.layout_mesh().edges()) {
-        if (em.is_embedded(l_e)) {
-            result.insert(l_e);
+    for (int i = 0; i < (int)embedded_flags.size(); ++i) {
+        if (embedded_flags[i]) {
+            result.insert(result.end(), pm::edge_index(i));
         }
     }
     return result;
@@ -175,9 +346,9 @@ std::set<pm::edge_index> EmbeddingState::embedded_edges() const
 std::set<polymesh::edge_index> EmbeddingState::unembedded_edges() const
 {
     std::set<pm::edge_index> result;
-    for (const auto l_e : em.layout_mesh().edges()) {
-        if (!em.is_embedded(l_e)) {
-            result.insert(l_e);
+    for (int i = 0; i < (int)embedded_flags.size(); ++i) {
+        if (!embedded_flags[i]) {
+            result.insert(result.end(), pm::edge_index(i));
         }
     }
     return result;
@@ -186,13 +357,11 @@ std::set<polymesh::edge_index> EmbeddingState::unembedded_edges() const
 std::set<pm::edge_index> EmbeddingState::conflicting_edges() const
 {
     std::set<pm::edge_index> result;
-    for (const auto& [l_ei_A, l_ei_B] : conflicts) {
-        LE_ASSERT(l_ei_A != l_ei_B);
-        LE_ASSERT(!em.is_embedded(l_ei_A));
-        LE_ASSERT(!em.is_embedded(l_ei_B));
-
-        result.insert(l_ei_A);
-        result.insert(l_ei_B);
+    for (int i = 0; i < (int)conflicting_flags.size(); ++i) {
+        if (conflicting_flags[i]) {
+            LE_ASSERT(!embedded_flags[i]);
+            result.insert(result.end(), pm::edge_index(i));
+        }
     }
     return result;
 }
@@ -200,15 +369,37 @@ std::set<pm::edge_index> EmbeddingState::conflicting_edges() const
 std::set<pm::edge_index> EmbeddingState::non_conflicting_edges() const
 {
     std::set<pm::edge_index> result;
-    const auto& conf = conflicting_edges();
-    for (const auto l_e : em.layout_mesh().edges()) {
-        if (!em.is_embedded(l_e)) {
-            if (!conf.count(l_e)) {
-                result.insert(l_e);
-            }
+    for (int i = 0; i < (int)embedded_flags.size(); ++i) {
+        if (!embedded_flags[i] && !conflicting_flags[i]) {
+            result.insert(result.end(), pm::edge_index(i));
         }
     }
     return result;
 }
 
+bool EmbeddingState::is_conflicting(const pm::edge_index& _l_ei) const
+{
+    return conflicting_flags[_l_ei.value];
+}
+
+int EmbeddingState::num_embedded_edges() const
+{
+    return num_embedded;
+}
+
+int EmbeddingState::num_unembedded_edges() const
+{
+    return (int)embedded_flags.size() - num_embedded;
+}
+
+int EmbeddingState::num_conflicting_edges() const
+{
+    return num_conflicting;
+}
+
+int EmbeddingState::num_non_conflicting_edges() const
+{
+    return num_unembedded_edges() - num_conflicting;
+}
+
 }
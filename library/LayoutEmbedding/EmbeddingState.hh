@@ -1,9 +1,13 @@
 #pragma once
 
 #include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/ConflictGraph.hh>
 #include <LayoutEmbedding/Embedding.hh>
 #include <LayoutEmbedding/Hash.hh>
 #include <LayoutEmbedding/InsertionSequence.hh>
+#include <LayoutEmbedding/VirtualPathConflictSentinel.hh>
+
+#include <optional>
 
 namespace LayoutEmbedding {
 
@@ -20,12 +24,16 @@ struct EmbeddingState
 
     void compute_candidate_path(const pm::edge_index& _l_ei);
     void compute_all_candidate_paths();
+    void set_candidate_paths(const std::vector<VirtualPath>& _paths);
+    double candidate_path_length(const pm::edge_index& _l_ei) const; // Cached, infinity if there is no candidate path
     void detect_candidate_path_conflicts();
+    double compute_conflict_cost_increase() const;
 
     std::vector<pm::edge_index> get_conflicting_candidates(const pm::edge_index& _l_ei);
 
     bool valid() const;
     double cost_lower_bound() const;
+    double cost_estimate() const; // Lower bound plus conflict_cost_increase. Not a lower bound, only used for ordering.
     double embedded_cost() const;
     double unembedded_cost() const;
 
@@ -39,10 +47,45 @@ struct EmbeddingState
     std::set<pm::edge_index> conflicting_edges() const;
     std::set<pm::edge_index> non_conflicting_edges() const;
 
-    pm::edge_attribute<VirtualPath> candidate_paths;
-    std::set<std::pair<pm::edge_index, pm::edge_index>> conflicts;
+    bool is_conflicting(const pm::edge_index& _l_ei) const;
+
+    int num_embedded_edges() const;
+    int num_unembedded_edges() const;
+    int num_conflicting_edges() const;
+    int num_non_conflicting_edges() const;
+
+    /// Replaces the conflict relation and updates the conflicting edge flags.
+    void set_conflicts(const ConflictGraph& _conflicts);
+
+    pm::edge_attribute<VirtualPath> candidate_paths; // Modify via compute_candidate_path() or set_candidate_paths()
+    ConflictGraph conflicts; // Modify via set_conflicts()
+
+    // Estimated minimum cost of resolving the conflicts (see BranchAndBoundSettings::use_conflict_aware_priority).
+    // Updated in detect_candidate_path_conflicts(), reset whenever paths change.
+    double conflict_cost_increase = 0.0;
 
     const BranchAndBoundSettings* settings;
+
+private:
+    // Edge classification, indexed by layout edge index.
+    // Maintained in extend() and set_conflicts() so queries don't have to scan the layout.
+    std::vector<bool> embedded_flags;
+    std::vector<bool> conflicting_flags;
+    int num_embedded = 0;
+    int num_conflicting = 0;
+
+    // Cost accounting, updated whenever an edge is embedded or its candidate path changes.
+    void update_candidate_path_length(const pm::edge_index& _l_ei);
+    std::vector<double> candidate_lengths; // Indexed by layout edge index, 0 for embedded edges
+    double total_embedded_length = 0.0;
+    double total_candidate_length = 0.0;   // Over unembedded edges with a candidate path
+    int num_missing_candidates = 0;        // Unembedded edges without a candidate path
+
+    // Conflict detection state, kept between calls to detect_candidate_path_conflicts()
+    // so that only paths changed in the meantime have to be re-inserted.
+    // After copying, the sentinel still refers to the other Embedding and is rebound on first use.
+    std::optional<VirtualPathConflictSentinel> sentinel;
+    std::set<pm::edge_index> changed_labels;
 };
 
 }
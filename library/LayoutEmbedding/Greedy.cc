@@ -8,28 +8,82 @@
 #include <algorithm>
 #include <set>
 #include <queue>
+#include <random>
+#include <tuple>
 
 namespace LayoutEmbedding {
 
 namespace {
 
-/// Heuristic detection of paths that might introduce swirls after insertion.
-/// For each vertex around the face that is incident to _l_he on the left,
-/// a shortest path towards the given path is traced.
-/// If the path is hit from the right side (instead of the left), this is considered a potential swirl.
-/// Returns true if a potential swirl is detected, false otherwise.
-bool swirl_detection(Embedding& _em, const pm::halfedge_handle& _l_he, const VirtualPath& _path)
+/// Reusable buffers for swirl_detection(), indexed by target vertex.
+/// Only the entries listed in touched are non-default, so resetting is proportional to the explored region.
+/// The target mesh grows during embedding, so the buffers are enlarged on demand.
+struct SwirlDetectionScratch
 {
-    const pm::Mesh& l_m = _em.layout_mesh();
-    const pm::Mesh& t_m = _em.target_mesh();
-    const pm::vertex_attribute<tg::pos3>& t_pos = _em.target_pos();
+    struct Candidate
+    {
+        double distance;
+        pm::vertex_handle v;
 
-    // Walk along the VertexEdgePath and mark the vertices directly left and right of it with a special attribute:
-    // The indicator attribute assigns each vertex a value in {-1, 0, 1},
-    // -1 meaning it is directly on the left of the arc,
-    // 1 meaning it is directly on the right of the arc,
-    // 0 otherwise.
-    pm::vertex_attribute<int> t_indicator(t_m);
+        bool operator<(const Candidate& _rhs) const
+        {
+            return distance > _rhs.distance;
+        }
+    };
+
+    std::vector<int> indicator;
+    std::vector<double> distance;
+    std::vector<int> touched;
+    std::vector<Candidate> heap;
+
+    void prepare(const pm::Mesh& _t_m)
+    {
+        const int n = _t_m.vertices().size();
+        if ((int)indicator.size() < n) {
+            indicator.resize(n, 0);
+            distance.resize(n, std::numeric_limits<double>::infinity());
+        }
+    }
+
+    void set_indicator(const pm::vertex_index& _v, int _value)
+    {
+        indicator[_v.value] = _value;
+        touched.push_back(_v.value);
+    }
+
+    void set_distance(const pm::vertex_handle& _v, double _value)
+    {
+        distance[_v.idx.value] = _value;
+        touched.push_back(_v.idx.value);
+    }
+
+    void reset_distances()
+    {
+        for (const int i : touched) {
+            distance[i] = std::numeric_limits<double>::infinity();
+        }
+        heap.clear();
+    }
+
+    void reset()
+    {
+        for (const int i : touched) {
+            indicator[i] = 0;
+            distance[i] = std::numeric_limits<double>::infinity();
+        }
+        touched.clear();
+        heap.clear();
+    }
+};
+
+/// Mark the target vertices directly left and right of _path:
+/// The indicator assigns each vertex a value in {-1, 0, 1},
+/// -1 meaning it is directly on the left of the arc,
+/// 1 meaning it is directly on the right of the arc,
+/// 0 otherwise.
+void mark_path_sides(const Embedding& _em, const VirtualPath& _path, SwirlDetectionScratch& _scratch)
+{
+    const pm::Mesh& t_m = _em.target_mesh();
 
     LE_ASSERT(is_real_vertex(_path.front()));
     LE_ASSERT(is_real_vertex(_path.back()));
@@ -50,7 +104,7 @@ bool swirl_detection(Embedding& _em, const pm::halfedge_handle& _l_he, const Vir
                 while (vh_current != vh_end) {
                     if (is_real_vertex(vh_current.to)) {
                         const auto& v_to = real_vertex(vh_current.to);
-                        t_indicator[v_to] = -1; // "Left"
+                        _scratch.set_indicator(v_to, -1); // "Left"
                     }
                     vh_current = vh_current.rotated_cw();
                 }
@@ -58,7 +112,7 @@ bool swirl_detection(Embedding& _em, const pm::halfedge_handle& _l_he, const Vir
                 while (vh_current != vh_start) {
                     if (is_real_vertex(vh_current.to)) {
                         const auto& v_to = real_vertex(vh_current.to);
-                        t_indicator[v_to] = 1; // "Right"
+                        _scratch.set_indicator(v_to, 1); // "Right"
                     }
                     vh_current = vh_current.rotated_cw();
                 }
@@ -93,57 +147,62 @@ bool swirl_detection(Embedding& _em, const pm::halfedge_handle& _l_he, const Vir
             }
 
             LE_ASSERT(he.is_valid());
-            t_indicator[he.vertex_from()] = -1; // "Left"
-            t_indicator[he.vertex_to()] = 1; // "Right"
+            _scratch.set_indicator(he.vertex_from().idx, -1); // "Left"
+            _scratch.set_indicator(he.vertex_to().idx, 1); // "Right"
         }
     }
+}
 
-    // Start a shortest-path search from the seed vertices and see whether it first meets a vertex marked "Left" (good) or "Right" (bad)
-
-    struct Candidate
-    {
-        double distance;
-        pm::vertex_handle v;
-
-        bool operator<(const Candidate& _rhs) const
-        {
-            return distance > _rhs.distance;
-        }
-    };
+/// Start a shortest-path search from the target vertices around the layout face left of _l_he
+/// and see whether it first meets a vertex marked "Left" (good) or "Right" (bad) by mark_path_sides().
+/// _side is 1 if the marked path runs along _l_he and -1 if it runs in the opposite direction.
+/// The search gives up (no swirl) once it is more than _radius away from the seeds.
+bool swirl_search(const Embedding& _em, const pm::halfedge_handle& _l_he, int _side, double _radius, SwirlDetectionScratch& _scratch)
+{
+    const pm::vertex_attribute<tg::pos3>& t_pos = _em.target_pos();
+    auto& heap = _scratch.heap;
 
-    pm::vertex_attribute<double> distance(t_m, std::numeric_limits<double>::infinity());
-    std::priority_queue<Candidate> q;
-    std::vector<pm::vertex_handle> t_seed_vertices;
     const auto& l_f = _l_he.face();
     for (const auto l_v : l_f.vertices()) {
         if ((l_v == _l_he.vertex_from()) || (l_v == _l_he.vertex_to())) {
             continue;
         }
         const auto t_v = _em.matching_target_vertex(l_v);
-        t_seed_vertices.push_back(t_v);
-        distance[t_v] = 0.0;
-        q.push({0.0, t_v});
+        _scratch.set_distance(t_v, 0.0);
+        heap.push_back({0.0, t_v});
+        std::push_heap(heap.begin(), heap.end());
     }
 
-    while (!q.empty()) {
-        const auto c = q.top();
-        q.pop();
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end());
+        const auto c = heap.back();
+        heap.pop_back();
+
+        if (c.distance > _scratch.distance[c.v.idx.value]) {
+            continue; // Outdated entry
+        }
+        if (c.distance > _radius) {
+            // The path is far away from this face. Probably no spiral.
+            return false;
+        }
 
-        if (t_indicator[c.v] == -1) {
+        const int indicator = _side * _scratch.indicator[c.v.idx.value];
+        if (indicator == -1) {
             // We arrived on the correct (left) side of the path. Probably no spiral.
             return false;
         }
-        else if (t_indicator[c.v] == 1) {
+        else if (indicator == 1) {
             // We arrived on the wrong (right) side of the path. Spiral detected.
             return true;
         }
 
         for (const auto he : c.v.outgoing_halfedges()) {
             const auto& v_to = he.vertex_to();
-            const double new_distance = distance[c.v] + tg::distance(t_pos[c.v], t_pos[v_to]);
-            if (new_distance < distance[v_to]) {
-                distance[v_to] = new_distance;
-                q.push({new_distance, v_to});
+            const double new_distance = c.distance + tg::distance(t_pos[c.v], t_pos[v_to]);
+            if (new_distance < _scratch.distance[v_to.idx.value]) {
+                _scratch.set_distance(v_to, new_distance);
+                heap.push_back({new_distance, v_to});
+                std::push_heap(heap.begin(), heap.end());
             }
         }
     }
@@ -151,112 +210,264 @@ bool swirl_detection(Embedding& _em, const pm::halfedge_handle& _l_he, const Vir
     return false;
 }
 
-bool swirl_detection_bidirectional(Embedding& _em, const pm::halfedge_handle& _l_he, const VirtualPath& _path)
+/// Heuristic detection of paths that might introduce swirls after insertion.
+/// For each vertex around the face that is incident to _l_he on the left,
+/// a shortest path towards the given path is traced.
+/// If the path is hit from the right side (instead of the left), this is considered a potential swirl.
+/// The same test is then done for the face on the right, with the roles of the sides swapped.
+/// Searches are limited to _radius, within which all touched buffer entries are reset afterwards.
+/// Returns true if a potential swirl is detected, false otherwise.
+bool swirl_detection_bidirectional(const Embedding& _em, const pm::halfedge_handle& _l_he, const VirtualPath& _path, double _radius, SwirlDetectionScratch& _scratch)
 {
-    if (swirl_detection(_em, _l_he, _path)) {
-        return true;
-    }
-    else {
-        const auto l_he_opp = _l_he.opposite();
-        auto path_opp = _path;
-        std::reverse(path_opp.begin(), path_opp.end());
-        return swirl_detection(_em, l_he_opp, path_opp);
+    _scratch.prepare(_em.target_mesh());
+    mark_path_sides(_em, _path, _scratch);
+
+    bool swirl = swirl_search(_em, _l_he, 1, _radius, _scratch);
+    if (!swirl) {
+        _scratch.reset_distances();
+        swirl = swirl_search(_em, _l_he.opposite(), -1, _radius, _scratch);
     }
+
+    _scratch.reset();
+    return swirl;
 }
 
-/// [Kraevoy2003] / [Kraevoy2004] blocking condition.
-/// _l_h_seed is already (temporarily) embedded.
-bool is_blocking(const Embedding& _em, const pm::halfedge_handle& _l_h_seed)
+/// Reusable buffers for is_blocking(), indexed by target halfedge.
+/// Each halfedge h carries two sectors of h.face(): 2 * h + 0 is the part near h.vertex_from(), 2 * h + 1 the part near h.vertex_to().
+/// A trial path that is not yet embedded is represented by cuts between these sectors,
+/// so the patches on both sides can be flood-filled without copying and refining the target mesh.
+struct BlockingScratch
 {
-    LE_ASSERT(_em.is_embedded(_l_h_seed));
+    enum Cut : char
+    {
+        CutAlong = 1,  // Between the two sectors of h (the path crosses h)
+        CutCorner = 2, // Between sector 1 of h and sector 0 of h.next() (the path enters h.face() at h.vertex_to())
+        CutAcross = 4, // Between h and h.opposite() (the path runs along h)
+    };
 
-    // Find sets of layout vertices in patch defined by _l_h.
-    // Both in layout and target mesh.
-    std::set<pm::vertex_index> l_vertices;
-    std::set<pm::vertex_index> t_vertices;
+    std::vector<char> cuts;
+    std::vector<char> visited;
+    std::vector<int> touched_halfedges;
+    std::vector<int> touched_sectors;
+    std::vector<int> stack;
 
-    { // Collect vertices in layout
-        std::queue<pm::halfedge_handle> queue;
-        queue.push(_l_h_seed);
-
-        auto visited = _em.layout_mesh().faces().make_attribute<bool>(false);
-        while (!queue.empty()) {
-            const auto h = queue.front();
-            const auto f = h.face();
-            queue.pop();
-
-            if (visited[f])
-                continue;
-            visited[f] = true;
-
-            // Collect layout vertices
-            for (auto l_v : f.vertices())
-                l_vertices.insert(l_v.idx);
-
-            // Enqueue neighbors
-            for (auto l_h_f : f.halfedges()) {
-                const auto l_h_opp = l_h_f.opposite();
-                if (!_em.is_embedded(l_h_opp) && !visited[l_h_opp.face()]) {
-                    queue.push(l_h_opp);
-                }
-            }
+    void prepare(const pm::Mesh& _t_m)
+    {
+        const int n = _t_m.halfedges().size();
+        if ((int)cuts.size() < n) {
+            cuts.resize(n, 0);
+            visited.resize(2 * n, false);
         }
     }
 
-    { // Collect vertices in target mesh
-        std::queue<pm::halfedge_handle> queue;
-        queue.push(_em.get_embedded_target_halfedge(_l_h_seed));
+    void cut(const pm::halfedge_handle& _h, Cut _cut)
+    {
+        cuts[_h.idx.value] |= _cut;
+        touched_halfedges.push_back(_h.idx.value);
+    }
+
+    bool is_cut(const pm::halfedge_handle& _h, Cut _cut) const
+    {
+        return cuts[_h.idx.value] & _cut;
+    }
+
+    void reset_visited()
+    {
+        for (const int i : touched_sectors) {
+            visited[i] = false;
+        }
+        touched_sectors.clear();
+        stack.clear();
+    }
 
-        auto visited = _em.target_mesh().faces().make_attribute<bool>(false);
-        while (!queue.empty()) {
-            const auto h = queue.front();
-            const auto f = h.face();
-            queue.pop();
+    void reset()
+    {
+        for (const int i : touched_halfedges) {
+            cuts[i] = 0;
+        }
+        touched_halfedges.clear();
+        reset_visited();
+    }
+};
 
-            if (visited[f])
-                continue;
-            visited[f] = true;
+/// Layout vertices of the patch left of _l_h_seed, with _l_e treated as embedded.
+std::set<pm::vertex_index> layout_patch_vertices(const Embedding& _em, const pm::halfedge_handle& _l_h_seed, const pm::edge_handle& _l_e)
+{
+    std::set<pm::vertex_index> l_vertices;
+    std::queue<pm::halfedge_handle> queue;
+    queue.push(_l_h_seed);
 
-            // Collect layout vertices
-            for (auto t_v : f.vertices()) {
-                const auto l_v = _em.matching_layout_vertex(t_v);
-                if (l_v.is_valid())
-                    t_vertices.insert(l_v.idx);
-            }
+    auto visited = _em.layout_mesh().faces().make_attribute<bool>(false);
+    while (!queue.empty()) {
+        const auto h = queue.front();
+        const auto f = h.face();
+        queue.pop();
 
-            // Enqueue neighbors
-            for (auto t_h_f : f.halfedges()) {
-                const auto t_h_opp = t_h_f.opposite();
-                if (!_em.is_blocked(t_h_opp.edge()) && !visited[t_h_opp.face()]) {
-                    queue.push(t_h_opp);
-                }
+        if (visited[f])
+            continue;
+        visited[f] = true;
+
+        // Collect layout vertices
+        for (auto l_v : f.vertices())
+            l_vertices.insert(l_v.idx);
+
+        // Enqueue neighbors
+        for (auto l_h_f : f.halfedges()) {
+            const auto l_h_opp = l_h_f.opposite();
+            if (!_em.is_embedded(l_h_opp) && l_h_opp.edge() != _l_e && !visited[l_h_opp.face()]) {
+                queue.push(l_h_opp);
             }
         }
     }
+    return l_vertices;
+}
+
+/// Layout vertices matching the target vertices of the patch containing sector _seed.
+/// The patch is bounded by embedded paths and by the cuts in _scratch.
+std::set<pm::vertex_index> target_patch_vertices(const Embedding& _em, int _seed, BlockingScratch& _scratch)
+{
+    const pm::Mesh& t_m = _em.target_mesh();
+    std::set<pm::vertex_index> t_vertices;
+
+    auto visit = [&] (const pm::halfedge_handle& _h, int _side) {
+        const int sector = 2 * _h.idx.value + _side;
+        if (!_scratch.visited[sector]) {
+            _scratch.visited[sector] = true;
+            _scratch.touched_sectors.push_back(sector);
+            _scratch.stack.push_back(sector);
+        }
+    };
 
-    return l_vertices != t_vertices;
+    visit(t_m.halfedges()[pm::halfedge_index(_seed / 2)], _seed % 2);
+    while (!_scratch.stack.empty()) {
+        const int sector = _scratch.stack.back();
+        _scratch.stack.pop_back();
+        const auto h = t_m.halfedges()[pm::halfedge_index(sector / 2)];
+        const int side = sector % 2;
+
+        // Collect layout vertices
+        const auto t_v = (side == 0) ? h.vertex_from() : h.vertex_to();
+        const auto l_v = _em.matching_layout_vertex(t_v);
+        if (l_v.is_valid())
+            t_vertices.insert(l_v.idx);
+
+        // Enqueue neighbors within the face
+        if (!_scratch.is_cut(h, BlockingScratch::CutAlong)) {
+            visit(h, 1 - side);
+        }
+        if (side == 1 && !_scratch.is_cut(h, BlockingScratch::CutCorner)) {
+            visit(h.next(), 0);
+        }
+        if (side == 0 && !_scratch.is_cut(h.prev(), BlockingScratch::CutCorner)) {
+            visit(h.prev(), 1);
+        }
+
+        // Enqueue neighbor across the edge
+        const auto h_opp = h.opposite();
+        if (!h_opp.is_boundary() && !_em.is_blocked(h.edge()) && !_scratch.is_cut(h, BlockingScratch::CutAcross)) {
+            visit(h_opp, 1 - side);
+        }
+    }
+    return t_vertices;
 }
 
 /// [Kraevoy2003] / [Kraevoy2004] blocking condition.
 /// Check if sets of layout vertices left and right of path match between layout and target mesh.
-/// _l_e is not yet embedded.
-bool is_blocking(const Embedding& _em, const pm::edge_handle& _l_e, const VirtualPath& _path)
+/// _l_e is not yet embedded. Instead of embedding _path, it is recorded as cuts in _scratch,
+/// so the cost is proportional to the size of the patch containing the path.
+bool is_blocking(const Embedding& _em, const pm::edge_handle& _l_e, const VirtualPath& _path, BlockingScratch& _scratch)
 {
     LE_ASSERT(!_em.is_embedded(_l_e));
+    LE_ASSERT_GEQ(_path.size(), 2);
+    LE_ASSERT(is_real_vertex(_path.front()));
+    LE_ASSERT(is_real_vertex(_path.back()));
+
+    const pm::Mesh& t_m = _em.target_mesh();
+    _scratch.prepare(t_m);
+
+    // Halfedge of _t_e in the face that also contains _t_v (triangle meshes only)
+    auto halfedge_facing = [&] (const pm::edge_handle& _t_e, const pm::vertex_handle& _t_v) {
+        if (_t_e.halfedgeA().next().vertex_to() == _t_v) {
+            return _t_e.halfedgeA();
+        }
+        LE_ASSERT(_t_e.halfedgeB().next().vertex_to() == _t_v);
+        return _t_e.halfedgeB();
+    };
+
+    // Record the path as cuts
+    for (int i = 0; i < _path.size(); ++i) {
+        if (is_real_edge(_path[i])) {
+            const auto t_e = real_edge(_path[i], t_m);
+            _scratch.cut(t_e.halfedgeA(), BlockingScratch::CutAlong);
+            _scratch.cut(t_e.halfedgeB(), BlockingScratch::CutAlong);
+        }
+        if (i + 1 < _path.size()) {
+            const auto& vv0 = _path[i];
+            const auto& vv1 = _path[i + 1];
+            if (is_real_vertex(vv0) && is_real_vertex(vv1)) {
+                const auto t_h = pm::halfedge_from_to(real_vertex(vv0, t_m), real_vertex(vv1, t_m));
+                LE_ASSERT(t_h.is_valid());
+                _scratch.cut(t_h, BlockingScratch::CutAcross);
+                _scratch.cut(t_h.opposite(), BlockingScratch::CutAcross);
+            }
+            else if (is_real_vertex(vv0) != is_real_vertex(vv1)) {
+                const auto t_v = is_real_vertex(vv0) ? real_vertex(vv0, t_m) : real_vertex(vv1, t_m);
+                const auto t_e = is_real_edge(vv0) ? real_edge(vv0, t_m) : real_edge(vv1, t_m);
+                _scratch.cut(halfedge_facing(t_e, t_v).next(), BlockingScratch::CutCorner);
+            }
+        }
+    }
+
+    // Sectors left and right of the first path segment
+    int t_seed_left = -1;
+    int t_seed_right = -1;
+    const auto t_v_start = real_vertex(_path[0], t_m);
+    if (is_real_vertex(_path[1])) {
+        const auto t_h = pm::halfedge_from_to(t_v_start, real_vertex(_path[1], t_m));
+        t_seed_left = 2 * t_h.idx.value + 0;
+        t_seed_right = 2 * t_h.opposite().idx.value + 1;
+    }
+    else {
+        const auto t_h = halfedge_facing(real_edge(_path[1], t_m), t_v_start);
+        t_seed_left = 2 * t_h.next().idx.value + 1;
+        t_seed_right = 2 * t_h.next().next().idx.value + 0;
+    }
 
-    // Copy embedding to temporarily embed the path
-    Embedding em_copy = _em;
-    em_copy.embed_path(_l_e.halfedgeA(), _path);
+    bool blocking = layout_patch_vertices(_em, _l_e.halfedgeA(), _l_e) != target_patch_vertices(_em, t_seed_left, _scratch);
+    if (!blocking) {
+        _scratch.reset_visited();
+        blocking = layout_patch_vertices(_em, _l_e.halfedgeB(), _l_e) != target_patch_vertices(_em, t_seed_right, _scratch);
+    }
 
-    return is_blocking(em_copy, _l_e.halfedgeA()) || is_blocking(em_copy, _l_e.halfedgeB());
+    _scratch.reset();
+    return blocking;
 }
 
 }
 
-GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings, const std::string& _name)
+GreedyRootPaths::GreedyRootPaths(const Embedding& _em)
+{
+    const pm::Mesh& l_m = _em.layout_mesh();
+    paths.resize(l_m.edges().size());
+    lengths.resize(l_m.edges().size());
+    for (const auto l_e : l_m.edges()) {
+        LE_ASSERT(!_em.is_embedded(l_e));
+        paths[l_e.idx.value] = _em.find_shortest_path(l_e.halfedgeA());
+        lengths[l_e.idx.value] = _em.path_length(paths[l_e.idx.value]);
+    }
+}
+
+GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings, const std::string& _name, const GreedyRootPaths* _root_paths)
 {
     GreedyResult result(_name, _settings);
 
+    // Root paths are used for the extremal vertex scoring and the first geodesic insertion step.
+    std::optional<GreedyRootPaths> own_root_paths;
+    if (!_root_paths && (_settings.prefer_extremal_vertices || !_settings.use_vertex_repulsive_tracing)) {
+        own_root_paths.emplace(_em);
+        _root_paths = &own_root_paths.value();
+    }
+
     // If vertex-repulsive tracing is enabled, copy input embedding.
     // Used to re-trace paths as shortest paths.
     std::optional<Embedding> em_copy;
@@ -272,9 +483,8 @@ GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings, const
         for (const auto l_v : l_m.vertices()) {
             double total_distance = 0.0;
             int valence = 0;
-            for (const auto l_he : l_v.outgoing_halfedges()) {
-                const auto path = _em.find_shortest_path(l_he);
-                total_distance += _em.path_length(path);
+            for (const auto l_e : l_v.edges()) {
+                total_distance += _root_paths->lengths[l_e.idx.value];
                 ++valence;
             }
             l_avg_neighbor_distance[l_v] = total_distance / valence;
@@ -303,8 +513,21 @@ GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings, const
         }
     };
 
+    // Per-edge cost perturbation for randomized restarts.
+    // It is fixed for the whole run, so lazily known costs remain lower bounds.
+    pm::edge_attribute<double> l_cost_factor(l_m, 1.0);
+    if (_settings.cost_noise > 0.0) {
+        std::mt19937 rng(_settings.random_seed);
+        std::uniform_real_distribution<double> dist(1.0 - _settings.cost_noise, 1.0 + _settings.cost_noise);
+        for (const auto l_e : l_m.edges()) {
+            l_cost_factor[l_e] = dist(rng);
+        }
+    }
+
     // If edges fail the "Swirl Test", their score will receive a penalty so they are processed later.
     pm::edge_attribute<bool> l_penalty(l_m);
+    SwirlDetectionScratch swirl_scratch;
+    BlockingScratch blocking_scratch;
 
     pm::edge_attribute<bool> l_is_embedded(l_m);
     const int l_num_vertices = l_m.vertices().size();
@@ -313,70 +536,139 @@ GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings, const
 
     UnionFind l_v_components(l_m.vertices().size());
 
+    // Lazy evaluation (CELF): Embedding a path mostly blocks parts of the target mesh,
+    // so the last known length of an edge is (up to new edge midpoints created by splits) a lower bound on its current length.
+    // This does not hold for swirl penalties, vertex-repulsive paths, and skipped blocking paths.
+    const bool lazy = _settings.use_lazy_evaluation
+            && _settings.insertion_order == GreedySettings::InsertionOrder::BestFirst
+            && !_settings.use_swirl_detection
+            && !_settings.use_vertex_repulsive_tracing
+            && !_settings.use_blocking_condition;
+
+    using LazyKey = std::tuple<int, double, int>; // (extremal priority, known path length, edge index)
+    std::priority_queue<LazyKey, std::vector<LazyKey>, std::greater<LazyKey>> lazy_queue;
+    std::vector<LazyKey> lazy_deferred; // Edges that would close a cycle before the spanning tree is complete
+    pm::edge_attribute<int> l_traced_at(l_m, -1); // Value of l_num_embedded_edges when the edge was last traced
+    pm::edge_attribute<VirtualPath> l_traced_path(l_m);
+    if (lazy) {
+        for (const auto l_e : l_m.edges()) {
+            lazy_queue.push({1 - incident_to_extremal_vertex(l_e), 0.0, l_e.idx.value});
+        }
+    }
+
     while (l_num_embedded_edges < l_num_edges) {
         VirtualPath best_path;
         double best_path_cost = std::numeric_limits<double>::infinity();
         pm::edge_handle best_l_e = pm::edge_handle::invalid;
 
         const bool is_spanning_tree = (l_num_embedded_edges >= l_num_vertices - 1);
+        if (is_spanning_tree) {
+            for (const auto& key : lazy_deferred) {
+                lazy_queue.push(key);
+            }
+            lazy_deferred.clear();
+        }
 
-        for (const auto l_e : l_m.edges()) {
-            if (l_is_embedded[l_e]) {
-                continue;
+        if (lazy) {
+            // Re-trace the edge with the smallest known cost until a freshly traced edge is on top.
+            // Ties are broken by edge index, just like in the exhaustive search below.
+            while (true) {
+                LE_ASSERT(!lazy_queue.empty());
+                const LazyKey key = lazy_queue.top();
+                lazy_queue.pop();
+                const auto l_e = l_m.edges()[pm::edge_index(std::get<2>(key))];
+
+                if (!is_spanning_tree && l_v_components.equivalent(l_e.vertexA().idx.value, l_e.vertexB().idx.value)) {
+                    lazy_deferred.push_back(key);
+                    continue;
+                }
+
+                if (l_traced_at[l_e] == l_num_embedded_edges) {
+                    best_l_e = l_e;
+                    best_path = l_traced_path[l_e];
+                    break;
+                }
+
+                if (l_num_embedded_edges == 0) {
+                    l_traced_path[l_e] = _root_paths->paths[l_e.idx.value];
+                }
+                else {
+                    l_traced_path[l_e] = _em.find_shortest_path(l_e.halfedgeA());
+                }
+                l_traced_at[l_e] = l_num_embedded_edges;
+                lazy_queue.push({std::get<0>(key), l_cost_factor[l_e] * _em.path_length(l_traced_path[l_e]), std::get<2>(key)});
             }
+        }
+        else {
+            for (const auto l_e : l_m.edges()) {
+                if (l_is_embedded[l_e]) {
+                    continue;
+                }
 
-            int l_vi_a = l_e.vertexA().idx.value;
-            int l_vi_b = l_e.vertexB().idx.value;
+                int l_vi_a = l_e.vertexA().idx.value;
+                int l_vi_b = l_e.vertexB().idx.value;
 
-            if (!_settings.use_blocking_condition) {
-                if (!is_spanning_tree) {
-                    if (l_v_components.equivalent(l_vi_a, l_vi_b)) {
-                        continue;
+                if (!_settings.use_blocking_condition) {
+                    if (!is_spanning_tree) {
+                        if (l_v_components.equivalent(l_vi_a, l_vi_b)) {
+                            continue;
+                        }
                     }
                 }
-            }
 
-            auto metric = Embedding::ShortestPathMetric::Geodesic;
-            if (_settings.use_vertex_repulsive_tracing) {
-                metric = Embedding::ShortestPathMetric::VertexRepulsive;
-            }
+                auto metric = Embedding::ShortestPathMetric::Geodesic;
+                if (_settings.use_vertex_repulsive_tracing) {
+                    metric = Embedding::ShortestPathMetric::VertexRepulsive;
+                }
 
-            VirtualPath path = _em.find_shortest_path(l_e.halfedgeA(), metric);
-            double path_cost = _em.path_length(path);
+                VirtualPath path;
+                double path_length;
+                if (l_num_embedded_edges == 0 && metric == Embedding::ShortestPathMetric::Geodesic) {
+                    path = _root_paths->paths[l_e.idx.value];
+                    path_length = _root_paths->lengths[l_e.idx.value];
+                }
+                else {
+                    path = _em.find_shortest_path(l_e.halfedgeA(), metric);
+                    path_length = _em.path_length(path);
+                }
+                double path_cost = path_length * l_cost_factor[l_e];
 
-            // If we use the blocking condition, we have to discard the path if
-            // the vertices enclosed in new patches differ between the layout and the embedding.
-            if (_settings.use_blocking_condition) {
-                if (l_v_components.equivalent(l_vi_a, l_vi_b)) {
-                    if (is_blocking(_em, l_e, path)) {
-                        continue;
+                // If we use the blocking condition, we have to discard the path if
+                // the vertices enclosed in new patches differ between the layout and the embedding.
+                if (_settings.use_blocking_condition) {
+                    if (l_v_components.equivalent(l_vi_a, l_vi_b)) {
+                        if (is_blocking(_em, l_e, path, blocking_scratch)) {
+                            continue;
+                        }
                     }
                 }
-            }
 
-            // If we use an arbitrary insertion order, we can early-out after the first path is found
-            if (_settings.insertion_order == GreedySettings::InsertionOrder::Arbitrary) {
-                best_path_cost = path_cost;
-                best_path = std::move(path);
-                best_l_e = l_e;
-                break;
-            }
+                // If we use an arbitrary insertion order, we can early-out after the first path is found
+                if (_settings.insertion_order == GreedySettings::InsertionOrder::Arbitrary) {
+                    best_path_cost = path_cost;
+                    best_path = std::move(path);
+                    best_l_e = l_e;
+                    break;
+                }
 
-            if (_settings.use_swirl_detection) {
-                // Only do the swirl test if the current path is already a contender.
-                if (path_cost < best_path_cost) {
-                    if (swirl_detection_bidirectional(_em, l_e.halfedgeA(), path)) {
-                        path_cost *= _settings.swirl_penalty_factor;
+                if (_settings.use_swirl_detection) {
+                    // Only do the swirl test if the current path is already a contender.
+                    if (path_cost < best_path_cost) {
+                        // The radius refers to the actual path length, not to the randomized cost
+                        const double radius = std::isinf(_settings.swirl_search_radius_factor) ? std::numeric_limits<double>::infinity() : _settings.swirl_search_radius_factor * path_length;
+                        if (swirl_detection_bidirectional(_em, l_e.halfedgeA(), path, radius, swirl_scratch)) {
+                            path_cost *= _settings.swirl_penalty_factor;
+                        }
                     }
                 }
-            }
 
-            const int extremal_priority = 1 - incident_to_extremal_vertex(l_e);
-            const int best_extremal_priority = 1 - incident_to_extremal_vertex(best_l_e);
-            if (std::tie(extremal_priority, path_cost) < std::tie(best_extremal_priority, best_path_cost)) {
-                best_path_cost = path_cost;
-                best_path = std::move(path);
-                best_l_e = l_e;
+                const int extremal_priority = 1 - incident_to_extremal_vertex(l_e);
+                const int best_extremal_priority = 1 - incident_to_extremal_vertex(best_l_e);
+                if (std::tie(extremal_priority, path_cost) < std::tie(best_extremal_priority, best_path_cost)) {
+                    best_path_cost = path_cost;
+                    best_path = std::move(path);
+                    best_l_e = l_e;
+                }
             }
         }
 
@@ -441,18 +733,28 @@ GreedyResult embed_schreiner(Embedding& _em, const GreedySettings& _settings)
 std::vector<GreedyResult> embed_greedy(Embedding& _em, const std::vector<GreedySettings>& _all_settings)
 {
     const int n = _all_settings.size();
-    std::vector<Embedding> all_embeddings(n, _em); // n copies
+
+    // Each variant works on its own copy of the input, since creating attributes
+    // (e.g. when copying an Embedding) modifies the layout mesh they are stored on.
+    std::vector<EmbeddingInput> all_inputs(n, _em.get_input()); // n copies
+    std::vector<Embedding> all_embeddings;
+    all_embeddings.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        all_embeddings.emplace_back(_em, all_inputs[i]);
+    }
     std::vector<GreedyResult> all_results(n);
 
-    //#pragma omp parallel for
-    for (std::size_t i = 0; i < n; ++i) {
+    // Traced once on the original, valid on all copies
+    const GreedyRootPaths root_paths(_em);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < n; ++i) {
         const auto& settings = _all_settings[i];
 
         auto& em = all_embeddings[i];
         auto& result = all_results[i];
 
-        em = _em; // copy
-        result = embed_greedy(em, settings);
+        result = embed_greedy(em, settings, "greedy", &root_paths);
 
         if (result.settings.use_swirl_detection)
             result.algorithm += "_swirl";
@@ -460,7 +762,12 @@ std::vector<GreedyResult> embed_greedy(Embedding& _em, const std::vector<GreedyS
             result.algorithm += "_repulsive";
         if (result.settings.prefer_extremal_vertices)
             result.algorithm += "_extremal";
+        if (result.settings.cost_noise > 0.0)
+            result.algorithm += "_randomized";
+    }
 
+    // Report in a fixed order, independent of thread scheduling
+    for (const auto& result : all_results) {
         std::cout << "Embedding cost: " << result.cost << std::endl;
     }
 
@@ -474,7 +781,7 @@ std::vector<GreedyResult> embed_greedy(Embedding& _em, const std::vector<GreedyS
     std::cout << "    prefer_extremal_vertices: " << best_result.settings.prefer_extremal_vertices << std::endl;
     std::cout << "Best cost: " << best_result.cost << std::endl;
 
-    _em = all_embeddings[best_idx]; // copy
+    _em = Embedding(all_embeddings[best_idx], _em.get_input()); // copy back onto the original input
 
     return all_results;
 }
@@ -518,6 +825,21 @@ std::vector<GreedyResult> embed_competitors(Embedding& _em, const GreedySettings
     return embed_greedy(_em, all_settings);
 }
 
+std::vector<GreedyResult> embed_randomized(Embedding& _em, int _num_restarts, const GreedySettings& _settings, double _cost_noise)
+{
+    LE_ASSERT_GEQ(_num_restarts, 1);
+
+    std::vector<GreedySettings> all_settings;
+    all_settings.push_back(_settings);
+    for (int i = 1; i < _num_restarts; ++i) {
+        GreedySettings settings = _settings;
+        settings.cost_noise = _cost_noise;
+        settings.random_seed = _settings.random_seed + i;
+        all_settings.push_back(settings);
+    }
+    return embed_greedy(_em, all_settings);
+}
+
 const GreedyResult& best(const std::vector<GreedyResult>& _results)
 {
     int best_idx;
@@ -3,6 +3,8 @@
 #include <LayoutEmbedding/Embedding.hh>
 #include <LayoutEmbedding/InsertionSequence.hh>
 
+#include <limits>
+
 namespace LayoutEmbedding {
 
 struct GreedySettings
@@ -14,9 +16,19 @@ struct GreedySettings
     };
     InsertionOrder insertion_order = InsertionOrder::BestFirst;
 
+    // Only re-trace the edge with the smallest previously known cost (CELF), which needs fewer searches.
+    // Only applies to the plain best-first variant: Ignored with an arbitrary insertion order, swirl detection,
+    // vertex-repulsive tracing, or the blocking condition (i.e. for embed_praun(), embed_kraevoy(), embed_schreiner()).
+    // Assumes that path lengths never decrease as paths get embedded. Embedding splits target edges, which creates
+    // new edge midpoints, so in rare cases a path can get shorter and the result can differ from the exhaustive search.
+    bool use_lazy_evaluation = true;
+
     // Try to detect swirled paths and postpone their embedding [Praun2001]
     bool use_swirl_detection = false;
     double swirl_penalty_factor = 2.0;
+    // The swirl search stops (no swirl) beyond this multiple of the tested path's length.
+    // Unbounded by default. A finite radius is faster, but may miss swirls and change the result.
+    double swirl_search_radius_factor = std::numeric_limits<double>::infinity();
 
     // Use path tracing using a harmonic field that tries to avoid layout vertices [Praun2001]
     bool use_vertex_repulsive_tracing = false;
@@ -27,6 +39,11 @@ struct GreedySettings
     // Prefer insertion of edges that connect extremal vertices (with large average distance to neighbors) [Schreiner2004]
     bool prefer_extremal_vertices = false;
     double extremal_vertex_ratio = 0.25;
+
+    // Randomized selection: the cost of each edge is scaled by a factor drawn once from [1 - cost_noise, 1 + cost_noise],
+    // which also breaks ties randomly. Used for restarts in embed_randomized(). 0 means deterministic.
+    double cost_noise = 0.0;
+    unsigned int random_seed = 0;
 };
 
 struct GreedyResult
@@ -42,8 +59,20 @@ struct GreedyResult
     double cost = std::numeric_limits<double>::infinity();
 };
 
+/// Geodesic shortest paths of all layout edges in an Embedding without embedded edges.
+/// They are the same for every greedy variant, so they are traced once and shared.
+/// Paths refer to target mesh elements by index, so they are valid on all copies of that Embedding.
+struct GreedyRootPaths
+{
+    explicit GreedyRootPaths(const Embedding& _em);
+
+    std::vector<VirtualPath> paths; // Indexed by layout edge index, traced along halfedgeA()
+    std::vector<double> lengths;
+};
+
 // Run a single greedy variant
-GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings = GreedySettings(), const std::string& _name = "greedy");
+// _root_paths must belong to (a copy of) _em. If nullptr, they are traced when needed.
+GreedyResult embed_greedy(Embedding& _em, const GreedySettings& _settings = GreedySettings(), const std::string& _name = "greedy", const GreedyRootPaths* _root_paths = nullptr);
 GreedyResult embed_praun(Embedding& _em, const GreedySettings& _settings = GreedySettings());
 GreedyResult embed_kraevoy(Embedding& _em, const GreedySettings& _settings = GreedySettings());
 GreedyResult embed_schreiner(Embedding& _em, const GreedySettings& _settings = GreedySettings());
@@ -52,6 +81,9 @@ GreedyResult embed_schreiner(Embedding& _em, const GreedySettings& _settings = G
 std::vector<GreedyResult> embed_greedy(Embedding& _em, const std::vector<GreedySettings>& _all_settings);
 std::vector<GreedyResult> embed_competitors(Embedding& _em, const GreedySettings& _settings = GreedySettings());
 
+// Run _num_restarts randomized variants of _settings in parallel (the first one unperturbed) and keep the best
+std::vector<GreedyResult> embed_randomized(Embedding& _em, int _num_restarts, const GreedySettings& _settings = GreedySettings(), double _cost_noise = 0.1);
+
 const GreedyResult& best(const std::vector<GreedyResult>& _results);
 const GreedyResult& best(const std::vector<GreedyResult>& _results, int& best_idx);
 
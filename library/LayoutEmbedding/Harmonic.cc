@@ -1,7 +1,6 @@
 #include "Harmonic.hh"
 
 #include <LayoutEmbedding/Util/Assert.hh>
-#include <Eigen/SparseLU>
 
 namespace LayoutEmbedding
 {
@@ -39,70 +38,258 @@ double mean_value_weight(
 
 }
 
-bool harmonic(
+HarmonicSolver::HarmonicSolver(
         const pm::vertex_attribute<tg::pos3>& _pos,
         const pm::vertex_attribute<bool>& _constrained,
-        const Eigen::MatrixXd& _constraint_values,
-        Eigen::MatrixXd& _res,
         const LaplaceWeights _weights,
-        const bool _fallback_iterative)
+        const LinearSolver _solver)
 {
     LE_ASSERT(_pos.mesh().is_compact());
 
-    const int n = _pos.mesh().vertices().size();
-    const int d = _constraint_values.cols();
-    LE_ASSERT_EQ(_constraint_values.rows(), n);
+    n = _pos.mesh().vertices().size();
+    symmetric = (_weights == LaplaceWeights::Uniform);
 
-    // Set up Laplace matrix and rhs
-    Eigen::MatrixXd rhs = Eigen::MatrixXd::Zero(n, d);
-    std::vector<Eigen::Triplet<double>> triplets;
+    // Number the unconstrained vertices
+    std::vector<int> reduced_idx(n, -1);
     for (auto v : _pos.mesh().vertices())
     {
-        const int i = v.idx.value;
+        if (!_constrained[v])
+        {
+            reduced_idx[v.idx.value] = free_vertices.size();
+            free_vertices.push_back(v.idx.value);
+        }
+    }
+    const int m = free_vertices.size();
+
+    // Set up negated Laplace matrix of the unconstrained vertices.
+    // Entries referring to constrained vertices go to B, which maps constraint values to the rhs.
+    std::vector<Eigen::Triplet<double>> triplets_A;
+    std::vector<Eigen::Triplet<double>> triplets_B;
+    for (const int i : free_vertices)
+    {
+        const auto v = _pos.mesh().vertices()[pm::vertex_index(i)];
+        const int ri = reduced_idx[i];
+        LE_ASSERT(!v.is_boundary());
+
+        for (auto h : v.outgoing_halfedges())
+        {
+            const int j = h.vertex_to().idx.value;
+            double w_ij;
+            if (_weights == LaplaceWeights::Uniform)
+                w_ij = 1.0;
+            else if (_weights == LaplaceWeights::MeanValue)
+                w_ij = mean_value_weight(_pos, h);
+            else
+                LE_ERROR_THROW("");
+
+            if (reduced_idx[j] >= 0)
+                triplets_A.push_back(Eigen::Triplet<double>(ri, reduced_idx[j], -w_ij));
+            else
+                triplets_B.push_back(Eigen::Triplet<double>(ri, j, w_ij));
+            triplets_A.push_back(Eigen::Triplet<double>(ri, ri, w_ij));
+        }
+    }
+
+    A.resize(m, m);
+    A.setFromTriplets(triplets_A.begin(), triplets_A.end());
+    A.makeCompressed();
+    B.resize(m, n);
+    B.setFromTriplets(triplets_B.begin(), triplets_B.end());
+
+    method = _solver;
+    if (method == LinearSolver::Automatic)
+        method = (m > multigrid_solver_min_unknowns) ? LinearSolver::Multigrid : LinearSolver::Direct;
+
+    if (m == 0)
+    {
+        factorized = true;
+    }
+    else if (method == LinearSolver::Iterative && symmetric)
+    {
+        cg.setTolerance(1e-10);
+        cg.compute(A);
+        factorized = (cg.info() == Eigen::Success);
+    }
+    else if (method == LinearSolver::Iterative)
+    {
+        bicgstab.setTolerance(1e-10);
+        bicgstab.compute(A);
+        factorized = (bicgstab.info() == Eigen::Success);
+    }
+    else if (method == LinearSolver::Multigrid && symmetric)
+    {
+        mg_cg.setTolerance(1e-10);
+        mg_cg.compute(A);
+        factorized = (mg_cg.info() == Eigen::Success);
+    }
+    else if (method == LinearSolver::Multigrid)
+    {
+        mg_bicgstab.setTolerance(1e-10);
+        mg_bicgstab.compute(A);
+        factorized = (mg_bicgstab.info() == Eigen::Success);
+    }
+    else if (symmetric)
+    {
+        ldlt.compute(A);
+        factorized = (ldlt.info() == Eigen::Success);
+        direct_factorized = factorized;
+    }
+    else
+    {
+        lu.compute(A);
+        factorized = (lu.info() == Eigen::Success);
+        direct_factorized = factorized;
+    }
+}
+
+bool HarmonicSolver::solve(
+        const Eigen::MatrixXd& _constraint_values,
+        Eigen::MatrixXd& _res) const
+{
+    LE_ASSERT_EQ(_constraint_values.rows(), n);
+    if (!factorized)
+        return false;
+
+    const int m = free_vertices.size();
+    const int d = _constraint_values.cols();
+
+    // Initial guess for the iterative solver
+    Eigen::MatrixXd x = Eigen::MatrixXd::Zero(m, d);
+    if (is_iterative() && _res.rows() == n && _res.cols() == d)
+    {
+        for (int k = 0; k < m; ++k)
+            x.row(k) = _res.row(free_vertices[k]);
+    }
+
+    // Constrained rows keep their values
+    _res = _constraint_values;
+    if (free_vertices.empty())
+        return true;
+
+    const Eigen::MatrixXd rhs = B * _constraint_values;
+    if (is_iterative())
+    {
+        std::lock_guard<std::mutex> lock(iterative_mutex);
+        Eigen::ComputationInfo info;
+        if (method == LinearSolver::Iterative && symmetric)
+        {
+            x = cg.solveWithGuess(rhs, x);
+            info = cg.info();
+        }
+        else if (method == LinearSolver::Iterative)
+        {
+            x = bicgstab.solveWithGuess(rhs, x);
+            info = bicgstab.info();
+        }
+        else if (symmetric)
+        {
+            x = mg_cg.solveWithGuess(rhs, x);
+            info = mg_cg.info();
+        }
+        else
+        {
+            x = mg_bicgstab.solveWithGuess(rhs, x);
+            info = mg_bicgstab.info();
+        }
+        if (info != Eigen::Success)
+            return false;
+    }
+    else if (!solve_factorized(rhs, x))
+    {
+        return false;
+    }
 
-        if (_constrained[v])
+    for (int k = 0; k < (int)free_vertices.size(); ++k)
+        _res.row(free_vertices[k]) = x.row(k);
+
+    return true;
+}
+
+bool HarmonicSolver::solve_direct(
+        const Eigen::MatrixXd& _constraint_values,
+        Eigen::MatrixXd& _res)
+{
+    LE_ASSERT_EQ(_constraint_values.rows(), n);
+
+    // Constrained rows keep their values
+    _res = _constraint_values;
+    if (free_vertices.empty())
+        return true;
+
+    if (!direct_factorized)
+    {
+        if (symmetric)
         {
-            triplets.push_back(Eigen::Triplet<double>(i, i, 1.0));
-            rhs.row(i) = _constraint_values.row(i);
+            ldlt.compute(A);
+            direct_factorized = (ldlt.info() == Eigen::Success);
         }
         else
         {
-            LE_ASSERT(!v.is_boundary());
-
-            for (auto h : v.outgoing_halfedges())
-            {
-                const int j = h.vertex_to().idx.value;
-                double w_ij;
-                if (_weights == LaplaceWeights::Uniform)
-                    w_ij = 1.0;
-                else if (_weights == LaplaceWeights::MeanValue)
-                    w_ij = mean_value_weight(_pos, h);
-                else
-                    LE_ERROR_THROW("");
-
-                triplets.push_back(Eigen::Triplet<double>(i, j, w_ij));
-                triplets.push_back(Eigen::Triplet<double>(i, i, -w_ij));
-            }
+            lu.compute(A);
+            direct_factorized = (lu.info() == Eigen::Success);
         }
+        if (!direct_factorized)
+            return false;
     }
 
-    Eigen::SparseMatrix<double> L(n, n);
-    L.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::MatrixXd x;
+    if (!solve_factorized(B * _constraint_values, x))
+        return false;
+
+    for (int k = 0; k < (int)free_vertices.size(); ++k)
+        _res.row(free_vertices[k]) = x.row(k);
+
+    return true;
+}
 
-    Eigen::SparseLU<Eigen::SparseMatrix<double>> solver;
-    solver.compute(L);
-    if (solver.info() == Eigen::Success)
+bool HarmonicSolver::solve_factorized(
+        const Eigen::MatrixXd& _rhs,
+        Eigen::MatrixXd& _x) const
+{
+    LE_ASSERT(direct_factorized);
+    if (symmetric)
     {
-        _res = solver.solve(rhs);
-        if (solver.info() == Eigen::Success)
-            return true;
+        _x = ldlt.solve(_rhs);
+        return ldlt.info() == Eigen::Success;
+    }
+    else
+    {
+        _x = lu.solve(_rhs);
+        return lu.info() == Eigen::Success;
     }
+}
 
-    std::cout << "LU solve failed" << std::endl;
+bool harmonic(
+        const pm::vertex_attribute<tg::pos3>& _pos,
+        const pm::vertex_attribute<bool>& _constrained,
+        const Eigen::MatrixXd& _constraint_values,
+        Eigen::MatrixXd& _res,
+        const LaplaceWeights _weights,
+        const bool _fallback_iterative,
+        const LinearSolver _solver)
+{
+    const int n = _pos.mesh().vertices().size();
+    LE_ASSERT_EQ(_constraint_values.rows(), n);
+
+    // Keep a previous solution as initial guess for the fallback
+    const Eigen::MatrixXd guess = _res;
+
+    const HarmonicSolver solver(_pos, _constrained, _weights, _solver);
+    if (solver.solve(_constraint_values, _res))
+        return true;
 
-    if (_fallback_iterative)
+    std::cout << "Harmonic solve failed" << std::endl;
+
+    if (_fallback_iterative && !solver.is_iterative())
     {
         std::cout << "Falling back to iterative solver" << std::endl;
+
+        const HarmonicSolver iterative_solver(_pos, _constrained, _weights, LinearSolver::Iterative);
+        _res = guess;
+        if (iterative_solver.solve(_constraint_values, _res))
+            return true;
+
+        std::cout << "Iterative solve failed" << std::endl;
     }
 
     return false;
@@ -114,7 +301,9 @@ bool harmonic_parametrization(
         const VertexParam& _constraint_values,
         VertexParam& _res,
         const LaplaceWeights _weights,
-        const bool _fallback_iterative)
+        const bool _fallback_iterative,
+        const LinearSolver _solver,
+        const VertexParam* _initial_guess)
 {
     const int n = _pos.mesh().vertices().size();
     const int d = 2;
@@ -124,9 +313,17 @@ bool harmonic_parametrization(
     for (auto v : _pos.mesh().vertices())
         constraint_values.row(v.idx.value) = Eigen::Vector2d(_constraint_values[v].x, _constraint_values[v].y);
 
-    // Compute
+    // Convert initial guess
     Eigen::MatrixXd res_mat;
-    if (!harmonic(_pos, _constrained, constraint_values, res_mat, _weights, _fallback_iterative))
+    if (_initial_guess)
+    {
+        res_mat = Eigen::MatrixXd::Zero(n, d);
+        for (auto v : _pos.mesh().vertices())
+            res_mat.row(v.idx.value) = Eigen::Vector2d((*_initial_guess)[v].x, (*_initial_guess)[v].y);
+    }
+
+    // Compute
+    if (!harmonic(_pos, _constrained, constraint_values, res_mat, _weights, _fallback_iterative, _solver))
         return false;
 
     // Convert result
@@ -1,10 +1,16 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/SparseCholesky>
+#include <Eigen/SparseLU>
 #include <polymesh/pm.hh>
 #include <typed-geometry/tg.hh>
+#include <LayoutEmbedding/Multigrid.hh>
 #include <LayoutEmbedding/Parametrization.hh>
 
+#include <mutex>
+
 namespace LayoutEmbedding
 {
 
@@ -14,6 +20,68 @@ enum class LaplaceWeights
     MeanValue,
 };
 
+enum class LinearSolver
+{
+    Direct,    // Sparse Cholesky (symmetric) or LU factorization
+    Iterative, // Incomplete factorization preconditioned CG (symmetric) or BiCGSTAB, for ill-conditioned systems
+    Multigrid, // Algebraic multigrid preconditioned CG (symmetric) or BiCGSTAB, linear memory and time for very large systems
+    Automatic, // Multigrid above multigrid_solver_min_unknowns, direct otherwise
+};
+
+/// Size of the reduced system above which LinearSolver::Automatic chooses the multigrid solver.
+constexpr int multigrid_solver_min_unknowns = 200000;
+
+/// Factorization of the Laplace system with the constrained vertices eliminated.
+/// Only the unconstrained vertices remain as unknowns, and the constraints move to the right-hand side.
+/// For symmetric weights (Uniform) the reduced system is symmetric positive definite and solved via SimplicialLDLT,
+/// otherwise (MeanValue) via SparseLU.
+/// The iterative solvers use conjugate gradients (symmetric) or BiCGSTAB, preconditioned by incomplete factorization
+/// or by an algebraic multigrid hierarchy (see MultigridPreconditioner), and can be warm-started from a previous solution.
+/// Can be reused to compute harmonic fields for different constraint values on the same mesh and constrained set.
+class HarmonicSolver
+{
+public:
+    HarmonicSolver(
+            const pm::vertex_attribute<tg::pos3>& _pos,
+            const pm::vertex_attribute<bool>& _constrained,
+            const LaplaceWeights _weights,
+            const LinearSolver _solver = LinearSolver::Direct);
+
+    /// False if the factorization (or preconditioner) failed.
+    bool ok() const { return factorized; }
+    bool is_symmetric() const { return symmetric; }
+    bool is_iterative() const { return method != LinearSolver::Direct; }
+
+    /// _constraint_values has one row per vertex (only constrained rows are read), and one column per field.
+    /// The iterative solver starts from _res if it has the same shape (e.g. holds a previous solution).
+    bool solve(const Eigen::MatrixXd& _constraint_values, Eigen::MatrixXd& _res) const;
+
+    /// Like solve(), but always uses a sparse factorization, which is computed on first use.
+    /// Fallback for failed iterative solves. Not thread-safe.
+    bool solve_direct(const Eigen::MatrixXd& _constraint_values, Eigen::MatrixXd& _res);
+
+    const Eigen::SparseMatrix<double>& matrix() const { return A; }
+
+private:
+    bool solve_factorized(const Eigen::MatrixXd& _rhs, Eigen::MatrixXd& _x) const;
+
+    int n = 0;                                     // Number of vertices
+    std::vector<int> free_vertices;                // Vertex index per unknown
+    Eigen::SparseMatrix<double> A;                 // Reduced system matrix (unknowns x unknowns)
+    Eigen::SparseMatrix<double> B;                 // Constraint coupling (unknowns x vertices)
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> ldlt;
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> lu;
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper, Eigen::IncompleteCholesky<double>> cg;
+    Eigen::BiCGSTAB<Eigen::SparseMatrix<double>, Eigen::IncompleteLUT<double>> bicgstab;
+    Eigen::ConjugateGradient<Eigen::SparseMatrix<double>, Eigen::Lower | Eigen::Upper, MultigridPreconditioner> mg_cg;
+    Eigen::BiCGSTAB<Eigen::SparseMatrix<double>, MultigridPreconditioner> mg_bicgstab;
+    mutable std::mutex iterative_mutex; // Eigen's iterative solvers record statistics in solve(), so they can't solve concurrently
+    LinearSolver method = LinearSolver::Direct;
+    bool symmetric = false;
+    bool factorized = false;
+    bool direct_factorized = false; // ldlt or lu
+};
+
 /// Compute harmonic field using mean-value weights.
 bool harmonic(
         const pm::vertex_attribute<tg::pos3>& _pos,
@@ -21,15 +89,20 @@ bool harmonic(
         const Eigen::MatrixXd& _constraint_values,
         Eigen::MatrixXd& _res,
         const LaplaceWeights _weights,
-        const bool _fallback_iterative = false);
+        const bool _fallback_iterative = false,
+        const LinearSolver _solver = LinearSolver::Direct);
 
 /// Compute harmonic field using mean-value weights.
+/// Iterative solvers start from _initial_guess if given (e.g. a previous solution with other weights).
+/// _initial_guess may alias _res.
 bool harmonic_parametrization(
         const pm::vertex_attribute<tg::pos3>& _pos,
         const pm::vertex_attribute<bool>& _constrained,
         const VertexParam& _constraint_values,
         VertexParam& _res,
         const LaplaceWeights _weights,
-        const bool _fallback_iterative = false);
+        const bool _fallback_iterative = false,
+        const LinearSolver _solver = LinearSolver::Direct,
+        const VertexParam* _initial_guess = nullptr);
 
 }
@@ -0,0 +1,212 @@
+#include "Multigrid.hh"
+
+#include <LayoutEmbedding/Util/Assert.hh>
+
+#include <cmath>
+
+namespace LayoutEmbedding
+{
+
+namespace
+{
+
+using Matrix = MultigridPreconditioner::Matrix;
+
+/// Groups each row with its strongly connected neighbors [Vanek1996].
+/// Returns the aggregate index per row and the number of aggregates.
+std::vector<int> aggregate(
+        const Matrix& _A,
+        const Eigen::VectorXd& _diag,
+        const double _threshold,
+        int& _num_aggregates)
+{
+    const int n = _A.rows();
+
+    // Strong connections (off-diagonal)
+    auto is_strong = [&] (int i, int j, double a_ij) {
+        return i != j && std::abs(a_ij) >= _threshold * std::sqrt(std::abs(_diag[i] * _diag[j]));
+    };
+
+    std::vector<int> agg(n, -1);
+    _num_aggregates = 0;
+
+    // Pass 1: Rows whose strong neighborhood is still free seed a new aggregate
+    for (int i = 0; i < n; ++i)
+    {
+        if (agg[i] >= 0)
+            continue;
+
+        bool free = true;
+        for (Matrix::InnerIterator it(_A, i); it; ++it)
+        {
+            if (is_strong(i, it.col(), it.value()) && agg[it.col()] >= 0)
+            {
+                free = false;
+                break;
+            }
+        }
+        if (!free)
+            continue;
+
+        agg[i] = _num_aggregates;
+        for (Matrix::InnerIterator it(_A, i); it; ++it)
+        {
+            if (is_strong(i, it.col(), it.value()))
+                agg[it.col()] = _num_aggregates;
+        }
+        ++_num_aggregates;
+    }
+
+    // Pass 2: Remaining rows join the aggregate of their strongest aggregated neighbor
+    std::vector<int> agg_pass_1 = agg;
+    for (int i = 0; i < n; ++i)
+    {
+        if (agg[i] >= 0)
+            continue;
+
+        double best_strength = 0.0;
+        for (Matrix::InnerIterator it(_A, i); it; ++it)
+        {
+            if (is_strong(i, it.col(), it.value()) && agg_pass_1[it.col()] >= 0 && std::abs(it.value()) > best_strength)
+            {
+                best_strength = std::abs(it.value());
+                agg[i] = agg_pass_1[it.col()];
+            }
+        }
+    }
+
+    // Pass 3: Rows without aggregated strong neighbors form new aggregates with their free neighbors
+    for (int i = 0; i < n; ++i)
+    {
+        if (agg[i] >= 0)
+            continue;
+
+        agg[i] = _num_aggregates;
+        for (Matrix::InnerIterator it(_A, i); it; ++it)
+        {
+            if (is_strong(i, it.col(), it.value()) && agg[it.col()] < 0)
+                agg[it.col()] = _num_aggregates;
+        }
+        ++_num_aggregates;
+    }
+
+    return agg;
+}
+
+}
+
+void MultigridPreconditioner::build(Matrix _A)
+{
+    LE_ASSERT_EQ(_A.rows(), _A.cols());
+
+    levels.clear();
+    status = Eigen::Success;
+
+    Matrix A = std::move(_A);
+    while (true)
+    {
+        Level level;
+        level.A = std::move(A);
+        level.A.makeCompressed();
+        level.inv_diag = level.A.diagonal();
+        for (int i = 0; i < level.inv_diag.size(); ++i)
+        {
+            if (level.inv_diag[i] == 0.0)
+            {
+                status = Eigen::NumericalIssue;
+                return;
+            }
+        }
+        const Eigen::VectorXd diag = level.inv_diag;
+        level.inv_diag = level.inv_diag.cwiseInverse();
+
+        const int n = level.A.rows();
+        if (n <= coarsest_size || (int)levels.size() + 1 >= max_levels)
+        {
+            levels.push_back(std::move(level));
+            break;
+        }
+
+        int num_aggregates = 0;
+        const auto agg = aggregate(level.A, diag, strength_threshold, num_aggregates);
+        if (num_aggregates >= n)
+        {
+            // No coarsening possible
+            levels.push_back(std::move(level));
+            break;
+        }
+
+        // Tentative (piecewise constant) prolongation
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(n);
+        for (int i = 0; i < n; ++i)
+            triplets.push_back(Eigen::Triplet<double>(i, agg[i], 1.0));
+        Matrix P_tent(n, num_aggregates);
+        P_tent.setFromTriplets(triplets.begin(), triplets.end());
+
+        // Smoothed prolongation P = (I - w D^-1 A) P_tent
+        const Matrix DA = level.inv_diag.asDiagonal() * level.A;
+        const Matrix DAP = DA * P_tent;
+        Matrix P = P_tent - jacobi_weight * DAP;
+        P.prune(0.0);
+        level.P = P;
+        level.R = P.transpose();
+
+        // Galerkin coarse operator
+        const Matrix RA = level.R * level.A;
+        A = RA * level.P;
+        A.prune(0.0);
+
+        levels.push_back(std::move(level));
+    }
+
+    // Factorize coarsest level
+    coarse_solver.compute(Eigen::SparseMatrix<double>(levels.back().A));
+    if (coarse_solver.info() != Eigen::Success)
+        status = coarse_solver.info();
+}
+
+void MultigridPreconditioner::smooth(
+        const Level& _level,
+        const Eigen::VectorXd& _b,
+        Eigen::VectorXd& _x) const
+{
+    for (int k = 0; k < smoothing_steps; ++k)
+    {
+        const Eigen::VectorXd r = _b - _level.A * _x;
+        _x += jacobi_weight * _level.inv_diag.cwiseProduct(r);
+    }
+}
+
+void MultigridPreconditioner::v_cycle(
+        int _l,
+        const Eigen::VectorXd& _b,
+        Eigen::VectorXd& _x) const
+{
+    const Level& level = levels[_l];
+
+    if (_l == (int)levels.size() - 1)
+    {
+        _x = coarse_solver.solve(_b);
+        return;
+    }
+
+    smooth(level, _b, _x);
+
+    const Eigen::VectorXd r_coarse = level.R * (_b - level.A * _x);
+    Eigen::VectorXd e_coarse = Eigen::VectorXd::Zero(r_coarse.size());
+    v_cycle(_l + 1, r_coarse, e_coarse);
+    _x += level.P * e_coarse;
+
+    smooth(level, _b, _x);
+}
+
+Eigen::VectorXd MultigridPreconditioner::solve(const Eigen::VectorXd& _b) const
+{
+    LE_ASSERT(!levels.empty());
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(_b.size());
+    v_cycle(0, _b, x);
+    return x;
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseLU>
+
+#include <vector>
+
+namespace LayoutEmbedding
+{
+
+/// Algebraic multigrid (smoothed aggregation) for the sparse Laplace systems of harmonic fields.
+/// The hierarchy is built once in compute() and applied as one V-cycle per solve().
+/// Each level has a fraction of the unknowns of the one above, so memory and the cost of a cycle are linear in the system size.
+/// Implements the preconditioner interface of Eigen's iterative solvers (ConjugateGradient, BiCGSTAB).
+/// For symmetric matrices, the V-cycle is a symmetric operator.
+class MultigridPreconditioner
+{
+public:
+    using Matrix = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+    MultigridPreconditioner() = default;
+
+    template <typename MatType>
+    MultigridPreconditioner& analyzePattern(const MatType&) { return *this; }
+
+    template <typename MatType>
+    MultigridPreconditioner& factorize(const MatType& _A) { build(Matrix(_A)); return *this; }
+
+    template <typename MatType>
+    MultigridPreconditioner& compute(const MatType& _A) { build(Matrix(_A)); return *this; }
+
+    /// Approximates A^-1 _b by one V-cycle starting from zero.
+    Eigen::VectorXd solve(const Eigen::VectorXd& _b) const;
+
+    Eigen::ComputationInfo info() const { return status; }
+    int num_levels() const { return levels.size(); }
+
+    // Settings, take effect in the next compute()
+    int coarsest_size = 1000;         // Solve directly below this size
+    int max_levels = 25;
+    int smoothing_steps = 2;          // Pre- and post-smoothing sweeps (weighted Jacobi)
+    double jacobi_weight = 2.0 / 3.0;
+    double strength_threshold = 0.08; // |a_ij| >= threshold * sqrt(|a_ii a_jj|) counts as a strong connection
+
+private:
+    struct Level
+    {
+        Matrix A;
+        Eigen::VectorXd inv_diag;
+        Matrix P; // Prolongation from the next coarser level
+        Matrix R; // Restriction to the next coarser level (P^T)
+    };
+
+    void build(Matrix _A);
+    void smooth(const Level& _level, const Eigen::VectorXd& _b, Eigen::VectorXd& _x) const;
+    void v_cycle(int _l, const Eigen::VectorXd& _b, Eigen::VectorXd& _x) const;
+
+    std::vector<Level> levels;
+    Eigen::SparseLU<Eigen::SparseMatrix<double>> coarse_solver;
+    Eigen::ComputationInfo status = Eigen::Success;
+};
+
+}
@@ -0,0 +1,278 @@
+#include "NodeSelection.hh"
+
+#include <LayoutEmbedding/Util/Assert.hh>
+
+#include <algorithm>
+#include <optional>
+#include <tuple>
+
+namespace LayoutEmbedding {
+
+namespace {
+
+/// Binary heap of candidates. The top element is the greatest one w.r.t. Compare.
+template <typename Compare>
+struct CandidateHeap
+{
+    std::vector<Candidate> items;
+    Compare compare;
+
+    void push(const Candidate& _c)
+    {
+        items.push_back(_c);
+        std::push_heap(items.begin(), items.end(), compare);
+    }
+
+    Candidate pop()
+    {
+        LE_ASSERT(!items.empty());
+        std::pop_heap(items.begin(), items.end(), compare);
+        Candidate c = items.back();
+        items.pop_back();
+        return c;
+    }
+
+    bool empty() const
+    {
+        return items.empty();
+    }
+
+    std::size_t size() const
+    {
+        return items.size();
+    }
+
+    double min_lower_bound() const
+    {
+        double result = std::numeric_limits<double>::infinity();
+        for (const auto& c : items) {
+            result = std::min(result, c.lower_bound);
+        }
+        return result;
+    }
+};
+
+using PriorityHeap = CandidateHeap<std::less<Candidate>>;
+
+void set_depth(const Candidate& _parent, std::vector<Candidate>& _children)
+{
+    for (auto& child : _children) {
+        child.depth = _parent.depth + 1;
+        child.discrepancy = _parent.discrepancy;
+    }
+}
+
+/// Always expands the open node with the best priority.
+class BestFirstSelection : public NodeSelectionStrategy
+{
+public:
+    void push(const Candidate& _c) override
+    {
+        heap.push(_c);
+    }
+
+    void push_children(const Candidate& _parent, std::vector<Candidate> _children) override
+    {
+        set_depth(_parent, _children);
+        for (const auto& child : _children) {
+            heap.push(child);
+        }
+    }
+
+    Candidate pop() override
+    {
+        return heap.pop();
+    }
+
+    bool empty() const override
+    {
+        return heap.empty();
+    }
+
+    std::size_t size() const override
+    {
+        return heap.size();
+    }
+
+    double min_lower_bound() const override
+    {
+        return heap.min_lower_bound();
+    }
+
+private:
+    PriorityHeap heap;
+};
+
+/// Best-first search that periodically "plunges" into the tree (as in MIP solvers):
+/// Every _period-th node is followed by its best child, that one by its best child, and so on,
+/// until a node without children (a leaf, a dead end or a pruned node) is reached.
+/// The siblings encountered on the way are kept in the best-first queue.
+/// A plunge node that is pushed again right after it was popped (e.g. after lazy materialization) stays in the plunge.
+class DepthFirstPlungingSelection : public NodeSelectionStrategy
+{
+public:
+    explicit DepthFirstPlungingSelection(const int _period) :
+        period(_period)
+    {
+    }
+
+    void push(const Candidate& _c) override
+    {
+        if (plunge_node_popped) {
+            plunge_node_popped = false;
+            next = _c;
+        }
+        else {
+            heap.push(_c);
+        }
+    }
+
+    void push_children(const Candidate& _parent, std::vector<Candidate> _children) override
+    {
+        set_depth(_parent, _children);
+        plunge_node_popped = false;
+        if (plunging && !_children.empty()) {
+            const auto best_it = std::max_element(_children.begin(), _children.end()); // Greatest w.r.t. operator< has the best priority
+            next = *best_it;
+            _children.erase(best_it);
+        }
+        for (const auto& child : _children) {
+            heap.push(child);
+        }
+    }
+
+    Candidate pop() override
+    {
+        ++num_pops;
+        if (next.has_value()) {
+            const Candidate c = *next;
+            next.reset();
+            plunge_node_popped = true;
+            return c;
+        }
+        plunge_node_popped = false;
+        plunging = (period > 0) && (num_pops % period == 0);
+        return heap.pop();
+    }
+
+    bool empty() const override
+    {
+        return heap.empty() && !next.has_value();
+    }
+
+    std::size_t size() const override
+    {
+        return heap.size() + (next.has_value() ? 1 : 0);
+    }
+
+    double min_lower_bound() const override
+    {
+        double result = heap.min_lower_bound();
+        if (next.has_value()) {
+            result = std::min(result, next->lower_bound);
+        }
+        return result;
+    }
+
+private:
+    PriorityHeap heap;
+    std::optional<Candidate> next; // Next node of the current plunge
+    bool plunging = false;
+    bool plunge_node_popped = false; // The last popped node was the next node of the current plunge
+    int num_pops = 0;
+    int period;
+};
+
+/// Limited discrepancy search:
+/// Children are ranked by priority, the i-th best child has i more discrepancies than its parent.
+/// Nodes with at most _max_discrepancy discrepancies are explored first, in order of increasing discrepancy
+/// and depth-first within the same discrepancy. All remaining nodes are explored best-first afterwards.
+class LimitedDiscrepancySelection : public NodeSelectionStrategy
+{
+public:
+    explicit LimitedDiscrepancySelection(const int _max_discrepancy) :
+        max_discrepancy(_max_discrepancy)
+    {
+    }
+
+    void push(const Candidate& _c) override
+    {
+        route(_c);
+    }
+
+    void push_children(const Candidate& _parent, std::vector<Candidate> _children) override
+    {
+        set_depth(_parent, _children);
+        std::sort(_children.begin(), _children.end(), [](const Candidate& _a, const Candidate& _b) {
+            return _a.priority < _b.priority;
+        });
+        for (std::size_t i = 0; i < _children.size(); ++i) {
+            _children[i].discrepancy += i;
+            route(_children[i]);
+        }
+    }
+
+    Candidate pop() override
+    {
+        if (!low_discrepancy_heap.empty()) {
+            return low_discrepancy_heap.pop();
+        }
+        return heap.pop();
+    }
+
+    bool empty() const override
+    {
+        return low_discrepancy_heap.empty() && heap.empty();
+    }
+
+    std::size_t size() const override
+    {
+        return low_discrepancy_heap.size() + heap.size();
+    }
+
+    double min_lower_bound() const override
+    {
+        return std::min(low_discrepancy_heap.min_lower_bound(), heap.min_lower_bound());
+    }
+
+private:
+    struct DiscrepancyOrder
+    {
+        bool operator()(const Candidate& _a, const Candidate& _b) const
+        {
+            // Top of the heap: fewest discrepancies, then deepest, then best priority.
+            return std::make_tuple(_a.discrepancy, -_a.depth, _a.priority) > std::make_tuple(_b.discrepancy, -_b.depth, _b.priority);
+        }
+    };
+
+    void route(const Candidate& _c)
+    {
+        if (_c.discrepancy <= max_discrepancy) {
+            low_discrepancy_heap.push(_c);
+        }
+        else {
+            heap.push(_c);
+        }
+    }
+
+    CandidateHeap<DiscrepancyOrder> low_discrepancy_heap;
+    PriorityHeap heap;
+    int max_discrepancy;
+};
+
+}
+
+std::unique_ptr<NodeSelectionStrategy> make_node_selection_strategy(const BranchAndBoundSettings& _settings)
+{
+    switch (_settings.node_selection) {
+    case BranchAndBoundSettings::NodeSelection::BestFirst:
+        return std::make_unique<BestFirstSelection>();
+    case BranchAndBoundSettings::NodeSelection::DepthFirstPlunging:
+        return std::make_unique<DepthFirstPlungingSelection>(_settings.plunge_period);
+    case BranchAndBoundSettings::NodeSelection::LimitedDiscrepancy:
+        return std::make_unique<LimitedDiscrepancySelection>(_settings.max_discrepancy);
+    }
+    LE_ERROR_THROW("Unknown node selection strategy.");
+}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <LayoutEmbedding/BranchAndBound.hh>
+#include <LayoutEmbedding/Hash.hh>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace LayoutEmbedding {
+
+/// An open node of the branch-and-bound search tree.
+struct Candidate
+{
+    double lower_bound = std::numeric_limits<double>::infinity();
+    double priority = 0.0;
+
+    HashValue state_hash;
+
+    int depth = 0;       // Number of edges inserted on the way from the root
+    int discrepancy = 0; // Number of times a child other than the best one was chosen on the way from the root
+
+    // An unmaterialized candidate only describes the insertion of l_e into the state parent_hash.
+    // Its lower bound is optimistic and its state_hash is not known yet.
+    bool materialized = true;
+    HashValue parent_hash = 0;
+    pm::edge_index l_e;
+
+    bool operator<(const Candidate& _rhs) const
+    {
+        return priority > _rhs.priority;
+    }
+};
+
+/// Decides which open node is expanded next by the branch-and-bound search.
+/// Lower priority values are considered better.
+class NodeSelectionStrategy
+{
+public:
+    virtual ~NodeSelectionStrategy() = default;
+
+    virtual void push(const Candidate& _c) = 0;
+
+    /// Adds the children of the node _parent, which has just been expanded.
+    /// Sets depth and discrepancy of the children.
+    virtual void push_children(const Candidate& _parent, std::vector<Candidate> _children) = 0;
+
+    virtual Candidate pop() = 0;
+
+    virtual bool empty() const = 0;
+    virtual std::size_t size() const = 0;
+
+    /// Smallest lower bound among all open nodes (infinity if there are none).
+    virtual double min_lower_bound() const = 0;
+};
+
+std::unique_ptr<NodeSelectionStrategy> make_node_selection_strategy(const BranchAndBoundSettings& _settings);
+
+}
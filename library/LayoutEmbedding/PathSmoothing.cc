@@ -5,6 +5,12 @@
 #include <LayoutEmbedding/Util/Assert.hh>
 
 #include <glow-extras/timing/CpuTimer.hh>
+#include <omp.h>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <tuple>
 #include <queue>
 
 namespace LayoutEmbedding
@@ -13,6 +19,111 @@ namespace LayoutEmbedding
 namespace
 {
 
+double min_triangle_angle(
+        const tg::pos3& _p0,
+        const tg::pos3& _p1,
+        const tg::pos3& _p2)
+{
+    const double a0 = tg::angle_between(_p1 - _p0, _p2 - _p0).radians();
+    const double a1 = tg::angle_between(_p2 - _p1, _p0 - _p1).radians();
+    return std::min({a0, a1, M_PI - a0 - a1});
+}
+
+/// Smallest angle of the triangles incident to _t_v.
+double min_incident_angle(
+        const Embedding& _em,
+        const pm::vertex_handle& _t_v)
+{
+    double res = M_PI;
+    for (auto t_h : _t_v.outgoing_halfedges())
+    {
+        if (t_h.is_boundary())
+            continue;
+        const auto& pos = _em.target_pos();
+        res = std::min(res, min_triangle_angle(pos[_t_v], pos[t_h.vertex_to()], pos[t_h.next().vertex_to()]));
+    }
+    return res;
+}
+
+/// Whether _t_h can be collapsed (moving its from-vertex onto its to-vertex)
+/// without changing the topology, flipping triangles, or creating worse slivers.
+bool collapse_is_valid(
+        const Embedding& _em,
+        const pm::halfedge_handle& _t_h,
+        const double _sliver_angle)
+{
+    const auto t_v = _t_h.vertex_from();
+    const auto t_w = _t_h.vertex_to();
+    if (t_v.is_boundary() || t_w.is_boundary())
+        return false;
+
+    // Link condition: the only common neighbors are the two opposite vertices
+    const auto t_a = _t_h.next().vertex_to();
+    const auto t_b = _t_h.opposite().next().vertex_to();
+    if (t_a == t_b || t_a.outgoing_halfedges().size() <= 3 || t_b.outgoing_halfedges().size() <= 3)
+        return false;
+    const auto t_v_nbs = t_v.adjacent_vertices().to_vector();
+    for (auto t_x : t_w.adjacent_vertices())
+    {
+        if (t_x != t_a && t_x != t_b && std::find(t_v_nbs.begin(), t_v_nbs.end(), t_x) != t_v_nbs.end())
+            return false;
+    }
+
+    // Triangles around t_v that remain (with t_v moved to t_w)
+    const auto& pos = _em.target_pos();
+    for (auto t_h_out : t_v.outgoing_halfedges())
+    {
+        const auto t_x = t_h_out.vertex_to();
+        const auto t_y = t_h_out.next().vertex_to();
+        if (t_x == t_w || t_y == t_w)
+            continue;
+
+        const auto n_before = tg::cross(pos[t_x] - pos[t_v], pos[t_y] - pos[t_v]);
+        const auto n_after = tg::cross(pos[t_x] - pos[t_w], pos[t_y] - pos[t_w]);
+        if (tg::dot(n_before, n_after) <= 0.0)
+            return false;
+
+        const double angle_before = min_triangle_angle(pos[t_v], pos[t_x], pos[t_y]);
+        const double angle_after = min_triangle_angle(pos[t_w], pos[t_x], pos[t_y]);
+        if (angle_after < std::min(angle_before, _sliver_angle))
+            return false;
+    }
+
+    return true;
+}
+
+/// Collapses _t_h, keeping the path labels of the halfedges around its to-vertex.
+void collapse(
+        Embedding& _em,
+        const pm::halfedge_handle& _t_h)
+{
+    const auto t_w = _t_h.vertex_to();
+
+    // The collapse may keep either of two merged edges, so store the labels by neighbor vertex.
+    std::vector<std::tuple<pm::vertex_handle, pm::halfedge_handle, pm::halfedge_handle>> labels;
+    for (auto t_h_out : t_w.outgoing_halfedges())
+        labels.push_back({t_h_out.vertex_to(), _em.matching_layout_halfedge(t_h_out), _em.matching_layout_halfedge(t_h_out.opposite())});
+
+    _em.target_mesh().halfedges().collapse(_t_h);
+    LE_ASSERT(!t_w.is_removed());
+
+    for (auto t_h_out : t_w.outgoing_halfedges())
+    {
+        auto l_h = pm::halfedge_handle::invalid;
+        auto l_h_opp = pm::halfedge_handle::invalid;
+        for (const auto& [t_x, l_h_stored, l_h_opp_stored] : labels)
+        {
+            if (t_x == t_h_out.vertex_to())
+            {
+                l_h = l_h_stored;
+                l_h_opp = l_h_opp_stored;
+            }
+        }
+        _em.matching_layout_halfedge(t_h_out) = l_h;
+        _em.matching_layout_halfedge(t_h_out.opposite()) = l_h_opp;
+    }
+}
+
 }
 
 Embedding subdivide(
@@ -93,6 +204,79 @@ Embedding subdivide(
     return em;
 }
 
+Embedding decimate(
+        const Embedding& _em_orig,
+        const DecimationSettings& _settings)
+{
+    glow::timing::CpuTimer timer;
+
+    Embedding em = _em_orig; // copy
+    const int t_num_v_before = em.target_mesh().vertices().size();
+
+    // Vertices with smaller index are part of the input target mesh
+    const auto& input = em.get_input();
+    const int t_num_v_input = input.t_m.vertices().size();
+
+    double avg_edge_length = 0.0;
+    for (auto t_e : input.t_m.edges())
+        avg_edge_length += tg::distance(input.t_pos[t_e.vertexA()], input.t_pos[t_e.vertexB()]);
+    avg_edge_length /= input.t_m.edges().size();
+    const double min_edge_length = _settings.min_edge_length_factor * avg_edge_length;
+    const double sliver_angle = _settings.sliver_angle * M_PI / 180.0;
+
+    for (int pass = 0; pass < _settings.max_passes; ++pass)
+    {
+        int n_collapses = 0;
+        for (auto t_v : em.target_mesh().vertices())
+        {
+            if (t_v.idx.value < t_num_v_input || t_v.is_boundary() || em.is_blocked(t_v))
+                continue;
+
+            const bool sliver = min_incident_angle(em, t_v) < sliver_angle;
+
+            // Collapse into the nearest neighbor
+            auto t_h_best = pm::halfedge_handle::invalid;
+            double length_best = std::numeric_limits<double>::infinity();
+            for (auto t_h : t_v.outgoing_halfedges())
+            {
+                const double length = tg::distance(em.target_pos()[t_v], em.target_pos()[t_h.vertex_to()]);
+                if (length < length_best && (sliver || length < min_edge_length) && collapse_is_valid(em, t_h, sliver_angle))
+                {
+                    t_h_best = t_h;
+                    length_best = length;
+                }
+            }
+
+            if (t_h_best.is_valid())
+            {
+                collapse(em, t_h_best);
+                ++n_collapses;
+            }
+        }
+
+        if (n_collapses == 0)
+            break;
+    }
+
+    // Remove collapsed elements and update the landmark handles
+    em.target_mesh().compactify();
+    for (auto t_v : em.target_mesh().vertices())
+    {
+        const auto l_v = em.matching_layout_vertex(t_v);
+        if (l_v.is_valid())
+            em.matching_target_vertex(l_v) = t_v;
+    }
+
+    // Cached fields refer to the old vertex indices
+    em.reset_vertex_repulsive_energy();
+
+    std::cout << "Decimation took " << timer.elapsedSecondsD() << " s. "
+              << "Removed " << t_num_v_before - (int)em.target_mesh().vertices().size() << " of "
+              << t_num_v_before << " vertices." << std::endl;
+
+    return em;
+}
+
 namespace
 {
 
@@ -119,12 +303,69 @@ void preprocess_split_edges(
         std::cout << "Split " << n_splits << " edges during path smoothing preprocess." << std::endl;
 }
 
+/// Buffers on the target mesh that are reused for all flaps during smooth_paths().
+/// Only the entries of the current flap are set, and they are reset afterwards,
+/// so extracting a flap costs time proportional to the flap instead of the target mesh.
+struct FlapScratch
+{
+    explicit FlapScratch(const pm::Mesh& _t_m) :
+        v_target_to_region(_t_m.vertices().make_attribute<pm::vertex_handle>()),
+        f_visited(_t_m.faces().make_attribute<bool>(false))
+    {
+    }
+
+    pm::vertex_attribute<pm::vertex_handle> v_target_to_region;
+    pm::face_attribute<bool> f_visited;
+    std::vector<pm::vertex_handle> t_vertices; // Set entries of v_target_to_region
+    std::vector<pm::face_handle> t_faces;      // Set entries of f_visited
+
+    void reset()
+    {
+        for (auto t_v : t_vertices)
+            v_target_to_region[t_v] = pm::vertex_handle::invalid;
+        for (auto t_f : t_faces)
+            f_visited[t_f] = false;
+        t_vertices.clear();
+        t_faces.clear();
+    }
+};
+
+/// Collects the target faces of the patch of _l_f via flood fill (like Embedding::get_patch).
+void collect_patch(
+        const Embedding& _em,
+        const pm::face_handle& _l_f,
+        FlapScratch& _scratch)
+{
+    std::queue<pm::halfedge_handle> queue;
+    queue.push(_em.get_embedded_target_halfedge(_l_f.any_halfedge()));
+
+    while (!queue.empty()) {
+        const auto t_h = queue.front();
+        LE_ASSERT(t_h.is_valid());
+        const auto t_f = t_h.face();
+        queue.pop();
+
+        // Already visited?
+        if (_scratch.f_visited[t_f])
+            continue;
+        _scratch.f_visited[t_f] = true;
+        _scratch.t_faces.push_back(t_f);
+
+        // Enqueue neighbors (if not visited and not blocked)
+        for (auto t_h_inside : t_f.halfedges()) {
+            const auto t_h_outside = t_h_inside.opposite();
+            if (!_scratch.f_visited[t_h_outside.face()] && !_em.is_blocked(t_h_outside.edge()))
+                queue.push(t_h_outside);
+        }
+    }
+}
+
 void extract_flap_region(
         const Embedding& _em,
         const pm::halfedge_handle& _l_h,
         pm::Mesh& _region,
         pm::vertex_attribute<tg::pos3>& _region_pos,
-        pm::vertex_attribute<pm::vertex_handle>& _v_target_to_region,
+        FlapScratch& _scratch,
         pm::halfedge_attribute<pm::halfedge_handle>& _h_region_to_target)
 {
     // Init result
@@ -132,39 +373,40 @@ void extract_flap_region(
     _region_pos = _region.vertices().make_attribute<tg::pos3>();
 
     // Index maps
-    _v_target_to_region = _em.target_mesh().vertices().make_attribute<pm::vertex_handle>();
+    LE_ASSERT(_scratch.t_vertices.empty());
+    LE_ASSERT(_scratch.t_faces.empty());
+    auto& v_target_to_region = _scratch.v_target_to_region;
     _h_region_to_target = _region.halfedges().make_attribute<pm::halfedge_handle>();
 
     // Get target faces inside flap
-    const auto patch_A = _em.get_patch(_l_h.face());
-    const auto patch_B = _em.get_patch(_l_h.opposite_face());
-    auto flap = patch_A;
-    flap.insert(flap.end(), patch_B.begin(), patch_B.end());
+    collect_patch(_em, _l_h.face(), _scratch);
+    collect_patch(_em, _l_h.opposite_face(), _scratch);
 
     // Create region mesh
-    for (auto t_f : flap)
+    for (auto t_f : _scratch.t_faces)
     {
         // Add vertices to result mesh
         for (auto t_v : t_f.vertices())
         {
-            if (_v_target_to_region[t_v].is_invalid())
+            if (v_target_to_region[t_v].is_invalid())
             {
                 auto r_v = _region.vertices().add();
                 _region_pos[r_v] = _em.target_pos()[t_v];
-                _v_target_to_region[t_v] = r_v;
+                v_target_to_region[t_v] = r_v;
+                _scratch.t_vertices.push_back(t_v);
             }
         }
 
         // Add face to result mesh
         _region.faces().add(t_f.vertices().to_vector([&] (auto t_v) {
-            return _v_target_to_region[t_v];
+            return v_target_to_region[t_v];
         }));
 
         // Fill halfedge index map
         for (auto t_h : t_f.halfedges())
         {
-            const auto r_v_from = _v_target_to_region[t_h.vertex_from()];
-            const auto r_v_to = _v_target_to_region[t_h.vertex_to()];
+            const auto r_v_from = v_target_to_region[t_h.vertex_from()];
+            const auto r_v_to = v_target_to_region[t_h.vertex_to()];
             const auto r_h = pm::halfedge_from_to(r_v_from, r_v_to);
             LE_ASSERT(r_h.is_valid());
 
@@ -301,19 +543,22 @@ Snake transfer_snake_to_target(
 }
 
 /**
- * Parametrize flap and straighten edge.
+ * Parametrize flap and compute the straightened edge as a snake in the target mesh.
+ * Does not modify the embedding, so flaps without shared faces can be processed concurrently.
  */
-bool smooth_path(
-        Embedding& _em,
+bool compute_smoothed_path(
+        const Embedding& _em,
         const pm::halfedge_handle& _l_h,
-        const bool _quad_flap_to_rectangle)
+        const bool _quad_flap_to_rectangle,
+        FlapScratch& _scratch,
+        Snake& _t_snake)
 {
     // Extract flap region mesh
     pm::Mesh region;
     pm::vertex_attribute<tg::pos3> region_pos;
-    pm::vertex_attribute<pm::vertex_handle> v_target_to_region;
     pm::halfedge_attribute<pm::halfedge_handle> h_region_to_target;
-    extract_flap_region(_em, _l_h, region, region_pos, v_target_to_region, h_region_to_target);
+    extract_flap_region(_em, _l_h, region, region_pos, _scratch, h_region_to_target);
+    const auto& v_target_to_region = _scratch.v_target_to_region;
 
     // Construct 2D n-gon
     pm::vertex_attribute<bool> constrained;
@@ -323,11 +568,15 @@ bool smooth_path(
     // Compute harmonic parametrization
     // Try a few times with successively more uniform weights
     VertexParam region_param;
-    if (!harmonic_parametrization(region_pos, constrained, constraint_pos, region_param, LaplaceWeights::MeanValue, false) || !injective(region_param))
+    const bool mean_value_solved = harmonic_parametrization(region_pos, constrained, constraint_pos, region_param, LaplaceWeights::MeanValue, false, LinearSolver::Automatic);
+    if (!mean_value_solved || !injective(region_param))
     {
-        if (!harmonic_parametrization(region_pos, constrained, constraint_pos, region_param, LaplaceWeights::Uniform, true) || !injective(region_param))
+        // Iterative solvers start from the non-injective mean-value solution, if there is one
+        const VertexParam* initial_guess = mean_value_solved ? &region_param : nullptr;
+        if (!harmonic_parametrization(region_pos, constrained, constraint_pos, region_param, LaplaceWeights::Uniform, true, LinearSolver::Automatic, initial_guess) || !injective(region_param))
         {
             std::cout << "Path smoothing failed" << std::endl;
+            _scratch.reset();
             return false;
         }
     }
@@ -336,7 +585,24 @@ bool smooth_path(
     const auto r_v_from = v_target_to_region[_em.matching_target_vertex(_l_h.vertex_from())];
     const auto r_v_to = v_target_to_region[_em.matching_target_vertex(_l_h.vertex_to())];
     const auto r_snake = snake_from_parametrization(region_param, r_v_from, r_v_to);
-    const auto t_snake = transfer_snake_to_target(r_snake, h_region_to_target);
+    _t_snake = transfer_snake_to_target(r_snake, h_region_to_target);
+    _scratch.reset();
+
+    return true;
+}
+
+/**
+ * Parametrize flap and straighten edge.
+ */
+bool smooth_path(
+        Embedding& _em,
+        const pm::halfedge_handle& _l_h,
+        const bool _quad_flap_to_rectangle,
+        FlapScratch& _scratch)
+{
+    Snake t_snake;
+    if (!compute_smoothed_path(_em, _l_h, _quad_flap_to_rectangle, _scratch, t_snake))
+        return false;
 
     // Embed snake in target mesh
     _em.unembed_path(_l_h);
@@ -345,21 +611,75 @@ bool smooth_path(
     return true;
 }
 
+
+std::vector<tg::pos3> embedded_path_polyline(
+        const Embedding& _em,
+        const pm::halfedge_handle& _l_h)
+{
+    std::vector<tg::pos3> res;
+    for (auto t_v : _em.get_embedded_path(_l_h))
+        res.push_back(_em.target_pos()[t_v]);
+    return res;
+}
+
+/// Position at arc length fraction _t along the polyline.
+tg::pos3 polyline_point(
+        const std::vector<tg::pos3>& _polyline,
+        const std::vector<double>& _arc_length,
+        const double _t)
+{
+    const double s = _t * _arc_length.back();
+    const auto it = std::lower_bound(_arc_length.begin(), _arc_length.end(), s);
+    const int i = std::clamp((int)(it - _arc_length.begin()), 1, (int)_polyline.size() - 1);
+    const double seg = _arc_length[i] - _arc_length[i - 1];
+    const double lambda = seg > 0.0 ? std::clamp((s - _arc_length[i - 1]) / seg, 0.0, 1.0) : 0.0;
+    return tg::mix(_polyline[i - 1], _polyline[i], lambda);
+}
+
+/// Maximum distance between corresponding points (by arc length fraction) of two paths with the same end points.
+/// Samples as many points as the finer polyline has segments.
+double path_displacement(
+        const std::vector<tg::pos3>& _a,
+        const std::vector<tg::pos3>& _b)
+{
+    const auto arc_length = [] (const std::vector<tg::pos3>& _polyline) {
+        std::vector<double> res(_polyline.size(), 0.0);
+        for (int i = 1; i < (int)_polyline.size(); ++i)
+            res[i] = res[i - 1] + (double)tg::distance(_polyline[i - 1], _polyline[i]);
+        return res;
+    };
+    LE_ASSERT_GEQ(_a.size(), 2);
+    LE_ASSERT_GEQ(_b.size(), 2);
+    const int n_samples = std::max(_a.size(), _b.size()) - 1;
+    const auto arc_a = arc_length(_a);
+    const auto arc_b = arc_length(_b);
+
+    double res = 0.0;
+    for (int i = 1; i < n_samples; ++i)
+    {
+        const double t = (double)i / n_samples;
+        res = std::max(res, (double)tg::distance(polyline_point(_a, arc_a, t), polyline_point(_b, arc_b, t)));
+    }
+    return res;
+}
+
 }
 
 Embedding smooth_paths(
         const Embedding& _em_orig,
         const int _n_iters,
-        const bool _quad_flap_to_rectangle)
+        const bool _quad_flap_to_rectangle,
+        const bool _parallel)
 {
-    return smooth_paths(_em_orig, _em_orig.layout_mesh().edges().to_vector(), _n_iters, _quad_flap_to_rectangle);
+    return smooth_paths(_em_orig, _em_orig.layout_mesh().edges().to_vector(), _n_iters, _quad_flap_to_rectangle, _parallel);
 }
 
 Embedding smooth_paths(
         const Embedding& _em_orig,
         const std::vector<pm::edge_handle>& _l_edges,
         const int _n_iters,
-        const bool _quad_flap_to_rectangle)
+        const bool _quad_flap_to_rectangle,
+        const bool _parallel)
 {
     glow::timing::CpuTimer timer;
 
@@ -368,12 +688,70 @@ Embedding smooth_paths(
     // Split non-boundary edges with both end vertices on the same path
     preprocess_split_edges(em);
 
-    for (int iter = 0; iter < _n_iters; ++iter)
+    if (_parallel)
+    {
+        // Flaps within a class are disjoint: compute their snakes in parallel,
+        // then embed them sequentially (each only splits edges inside its own flap).
+        // Same result as smoothing the edges sequentially, class by class.
+        const auto classes = disjoint_flap_classes(_l_edges);
+
+        // Creating attributes on the target mesh is not thread-safe, so do it up front.
+        std::vector<std::unique_ptr<FlapScratch>> scratches;
+        for (int i = 0; i < omp_get_max_threads(); ++i)
+            scratches.push_back(std::make_unique<FlapScratch>(em.target_mesh()));
+
+        for (int iter = 0; iter < _n_iters; ++iter)
+        {
+            for (const auto& l_class : classes)
+            {
+                const int n = l_class.size();
+                std::vector<Snake> t_snakes(n);
+                std::vector<char> success(n, false);
+
+                // Exceptions (e.g. from failed assertions) must not leave the parallel region
+                std::vector<std::exception_ptr> errors(n);
+
+                #pragma omp parallel for schedule(dynamic)
+                for (int i = 0; i < n; ++i)
+                {
+                    auto& scratch = *scratches[omp_get_thread_num()];
+                    try
+                    {
+                        success[i] = compute_smoothed_path(em, l_class[i].halfedgeA(), _quad_flap_to_rectangle, scratch, t_snakes[i]);
+                    }
+                    catch (...)
+                    {
+                        errors[i] = std::current_exception();
+                    }
+                }
+
+                for (int i = 0; i < n; ++i)
+                {
+                    if (errors[i])
+                        std::rethrow_exception(errors[i]);
+                }
+
+                for (int i = 0; i < n; ++i)
+                {
+                    if (success[i])
+                    {
+                        em.unembed_path(l_class[i].halfedgeA());
+                        em.embed_path(l_class[i].halfedgeA(), t_snakes[i]);
+                    }
+                }
+            }
+        }
+    }
+    else
     {
-        for (auto l_e : _l_edges)
+        FlapScratch scratch(em.target_mesh());
+        for (int iter = 0; iter < _n_iters; ++iter)
         {
-            if (!l_e.is_boundary())
-                smooth_path(em, l_e.halfedgeA(), _quad_flap_to_rectangle);
+            for (auto l_e : _l_edges)
+            {
+                if (!l_e.is_boundary())
+                    smooth_path(em, l_e.halfedgeA(), _quad_flap_to_rectangle, scratch);
+            }
         }
     }
 
@@ -385,4 +763,141 @@ Embedding smooth_paths(
     return em;
 }
 
+std::vector<std::vector<pm::edge_handle>> disjoint_flap_classes(
+        const std::vector<pm::edge_handle>& _l_edges)
+{
+    std::vector<std::vector<pm::edge_handle>> classes;
+    std::vector<std::vector<pm::face_handle>> class_faces;
+    for (auto l_e : _l_edges)
+    {
+        if (l_e.is_boundary())
+            continue;
+
+        const auto l_fA = l_e.faceA();
+        const auto l_fB = l_e.faceB();
+        int color = 0;
+        while (color < (int)classes.size())
+        {
+            const auto& fs = class_faces[color];
+            if (std::find(fs.begin(), fs.end(), l_fA) == fs.end() && std::find(fs.begin(), fs.end(), l_fB) == fs.end())
+                break;
+            ++color;
+        }
+        if (color == (int)classes.size())
+        {
+            classes.emplace_back();
+            class_faces.emplace_back();
+        }
+        classes[color].push_back(l_e);
+        class_faces[color].push_back(l_fA);
+        class_faces[color].push_back(l_fB);
+    }
+    return classes;
+}
+
+Embedding smooth_paths_adaptive(
+        const Embedding& _em_orig,
+        const AdaptiveSmoothingSettings& _settings,
+        AdaptiveSmoothingStats* _stats)
+{
+    glow::timing::CpuTimer timer;
+
+    Embedding em = _em_orig; // copy
+    const pm::Mesh& l_m = em.layout_mesh();
+
+    // Split non-boundary edges with both end vertices on the same path
+    preprocess_split_edges(em);
+
+    // Bounding box diagonal
+    const float inf = std::numeric_limits<float>::infinity();
+    tg::pos3 p_min(inf, inf, inf);
+    tg::pos3 p_max(-inf, -inf, -inf);
+    for (auto t_v : em.target_mesh().vertices())
+    {
+        p_min = tg::min(p_min, em.target_pos()[t_v]);
+        p_max = tg::max(p_max, em.target_pos()[t_v]);
+    }
+    const double diagonal = tg::distance(p_min, p_max);
+    const double tolerance = _settings.displacement_tolerance * diagonal;
+
+    AdaptiveSmoothingStats stats;
+    FlapScratch scratch(em.target_mesh());
+
+    // Initially, all paths are on the worklist
+    std::vector<pm::edge_handle> worklist;
+    for (auto l_e : l_m.edges())
+    {
+        if (!l_e.is_boundary())
+            worklist.push_back(l_e);
+    }
+
+    auto l_queued = l_m.edges().make_attribute<bool>(false);
+    bool time_exceeded = false;
+    for (int round = 0; round < _settings.max_rounds && !worklist.empty() && !time_exceeded; ++round)
+    {
+        std::vector<pm::edge_handle> next_worklist;
+        double max_displacement = 0.0;
+        for (auto l_e : worklist)
+        {
+            if (timer.elapsedSecondsD() > _settings.time_limit)
+            {
+                time_exceeded = true;
+                break;
+            }
+
+            const auto l_h = l_e.halfedgeA();
+            const auto before = embedded_path_polyline(em, l_h);
+            if (!smooth_path(em, l_h, _settings.quad_flap_to_rectangle, scratch))
+                continue;
+            ++stats.num_paths_processed;
+
+            const double displacement = path_displacement(before, embedded_path_polyline(em, l_h));
+            max_displacement = std::max(max_displacement, displacement);
+            if (displacement <= tolerance)
+                continue;
+
+            // The flaps of all other edges of the adjacent faces contain this path
+            for (auto l_f : {l_e.faceA(), l_e.faceB()})
+            {
+                for (auto l_e_nb : l_f.edges())
+                {
+                    if (l_e_nb != l_e && !l_e_nb.is_boundary() && !l_queued[l_e_nb])
+                    {
+                        l_queued[l_e_nb] = true;
+                        next_worklist.push_back(l_e_nb);
+                    }
+                }
+            }
+        }
+
+        // Only report complete rounds
+        if (time_exceeded)
+        {
+            std::cout << "Smoothing round " << round << " interrupted by the time limit." << std::endl;
+            break;
+        }
+
+        stats.max_displacement.push_back(max_displacement / diagonal);
+        std::cout << "Smoothing round " << round << ": max displacement "
+                  << stats.max_displacement.back() << ", "
+                  << next_worklist.size() << " paths to re-smooth." << std::endl;
+
+        for (auto l_e : next_worklist)
+            l_queued[l_e] = false;
+        worklist = std::move(next_worklist);
+    }
+    stats.converged = worklist.empty() && !time_exceeded;
+
+    std::cout << "Adaptive smoothing (" << stats.num_paths_processed << " paths in "
+              << stats.max_displacement.size() << " rounds) took "
+              << timer.elapsedSecondsD() << " s. "
+              << "Resulting mesh has " << em.target_mesh().vertices().size() << " vertices."
+              << std::endl;
+
+    if (_stats)
+        *_stats = stats;
+
+    return em;
+}
+
 }
@@ -2,6 +2,8 @@
 
 #include <LayoutEmbedding/Embedding.hh>
 
+#include <limits>
+
 namespace LayoutEmbedding
 {
 
@@ -12,16 +14,46 @@ Embedding subdivide(
         const Embedding& _em_orig,
         const int _n_iters = 1);
 
+struct DecimationSettings
+{
+    // Collapse edges shorter than this, relative to the average edge length of the input target mesh.
+    double min_edge_length_factor = 0.2;
+
+    // Also collapse vertices of triangles with an angle smaller than this (in degrees).
+    double sliver_angle = 5.0;
+
+    int max_passes = 10;
+};
+
+/**
+ * Returns a new Embedding instance, in which target mesh
+ * vertices that were introduced by embedding (e.g. by
+ * path smoothing) and are not on any path have been
+ * collapsed into a neighbor if they have a short incident
+ * edge or belong to a sliver triangle.
+ * Embedded paths and landmarks are unchanged.
+ * Assumes that the first input.t_m.vertices().size() target vertices are the
+ * vertices of the input target mesh, i.e. that vertices were only ever appended
+ * (as by embedding, smoothing and subdivide). These are never collapsed.
+ */
+Embedding decimate(
+        const Embedding& _em_orig,
+        const DecimationSettings& _settings = {});
+
 /**
  * Returns a new Embedding instance, in which
  * embedded paths have been smoothed via straight
  * lines harmonic parametrizations of the two adjacent
  * patches, as described in [Praun2001].
+ * If _parallel is set, edges are grouped into classes with disjoint flaps,
+ * which are smoothed in parallel. The result is the same as smoothing
+ * the edges sequentially in that class order.
  */
 Embedding smooth_paths(
         const Embedding& _em_orig,
         const int _n_iters = 1,
-        const bool _quad_flap_to_rectangle = true);
+        const bool _quad_flap_to_rectangle = true,
+        const bool _parallel = false);
 
 /**
  * Smooth only selected edges
@@ -30,6 +62,46 @@ Embedding smooth_paths(
         const Embedding& _em_orig,
         const std::vector<pm::edge_handle>& _l_edges,
         const int _n_iters = 1,
-        const bool _quad_flap_to_rectangle = true);
+        const bool _quad_flap_to_rectangle = true,
+        const bool _parallel = false);
+
+/**
+ * Partition the edges into classes whose flaps share no faces,
+ * i.e. no two edges of a class are incident to the same layout face.
+ * Greedy coloring in the given order. Boundary edges are skipped.
+ * These are the classes smoothed in parallel by smooth_paths.
+ */
+std::vector<std::vector<pm::edge_handle>> disjoint_flap_classes(
+        const std::vector<pm::edge_handle>& _l_edges);
+
+struct AdaptiveSmoothingSettings
+{
+    // A path is re-smoothed if a path in its flap (i.e. an edge of one of its two adjacent layout faces)
+    // moved by more than this, relative to the target mesh bounding box diagonal.
+    double displacement_tolerance = 1e-3;
+
+    // Stop after this many seconds or rounds, even if the worklist is not empty.
+    double time_limit = std::numeric_limits<double>::infinity();
+    int max_rounds = 100;
+
+    bool quad_flap_to_rectangle = true;
+};
+
+struct AdaptiveSmoothingStats
+{
+    int num_paths_processed = 0;          // Including those of an interrupted round
+    std::vector<double> max_displacement; // Per complete round, relative to the bounding box diagonal
+    bool converged = false; // Worklist became empty
+};
+
+/**
+ * Smooths all paths once, then re-smooths only paths whose flap contains
+ * a path that moved by more than the tolerance, until no path moves
+ * (or the time / round budget is exhausted).
+ */
+Embedding smooth_paths_adaptive(
+        const Embedding& _em_orig,
+        const AdaptiveSmoothingSettings& _settings = {},
+        AdaptiveSmoothingStats* _stats = nullptr);
 
 }
@@ -174,9 +174,9 @@ HalfedgeParam parametrize_patches(
         // Compute Tutte embedding
         // Try a few times with successively more uniform weights
         VertexParam p_param;
-        if (!harmonic_parametrization(p_pos, p_constrained, p_constraint_value, p_param, LaplaceWeights::MeanValue, false))
+        if (!harmonic_parametrization(p_pos, p_constrained, p_constraint_value, p_param, LaplaceWeights::MeanValue, false, LinearSolver::Automatic))
         {
-            if (!harmonic_parametrization(p_pos, p_constrained, p_constraint_value, p_param, LaplaceWeights::Uniform, true))
+            if (!harmonic_parametrization(p_pos, p_constrained, p_constraint_value, p_param, LaplaceWeights::Uniform, true, LinearSolver::Automatic))
             {
                 LE_ERROR_THROW("Harmonic parametrization failed.");
             }
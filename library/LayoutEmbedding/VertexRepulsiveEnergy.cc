@@ -2,29 +2,97 @@
 
 #include <LayoutEmbedding/Harmonic.hh>
 
+#include <algorithm>
+#include <iostream>
+
 namespace LayoutEmbedding {
 
-Eigen::MatrixXd compute_vertex_repulsive_energy(const Embedding& _em)
-{
-    const int l_num_v = _em.layout_mesh().vertices().size();
-    const int t_num_v = _em.target_mesh().vertices().size();
+namespace {
 
-    // Set up boundary conditions
+pm::vertex_attribute<bool> constrained_landmarks(const Embedding& _em)
+{
     auto constrained = _em.target_mesh().vertices().make_attribute<bool>(false);
-    Eigen::MatrixXd constraint_values = Eigen::MatrixXd::Zero(t_num_v, l_num_v);
+    for (const auto l_v : _em.layout_mesh().vertices())
+        constrained[_em.matching_target_vertex(l_v)] = true;
+    return constrained;
+}
+
+}
 
+VertexRepulsiveEnergy::VertexRepulsiveEnergy(const Embedding& _em) :
+    t_num_v(_em.target_mesh().vertices().size()),
+    solver(_em.target_pos(), constrained_landmarks(_em), LaplaceWeights::MeanValue, LinearSolver::Automatic)
+{
+    // If the solver failed to set up, require() falls back to the direct solver
+    const int l_num_v = _em.layout_mesh().vertices().size();
     for (const auto l_v : _em.layout_mesh().vertices())
+        t_constrained_vertex.push_back(_em.matching_target_vertex(l_v).idx.value);
+
+    fields.resize(t_num_v, l_num_v);
+    solved = std::make_unique<std::atomic<bool>[]>(l_num_v);
+    for (int i = 0; i < l_num_v; ++i)
+        solved[i].store(false);
+}
+
+void VertexRepulsiveEnergy::require(const std::vector<int>& _l_vertices)
+{
+    bool all_solved = true;
+    for (const int l_v : _l_vertices)
+        all_solved = all_solved && is_solved(l_v);
+    if (all_solved)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<int> missing;
+    for (const int l_v : _l_vertices)
     {
-        const auto t_v = _em.matching_target_vertex(l_v);
-        constrained[t_v] = true;
-        constraint_values(t_v.idx.value, l_v.idx.value) = 1.0;
+        if (!is_solved(l_v) && std::find(missing.begin(), missing.end(), l_v) == missing.end())
+            missing.push_back(l_v);
     }
 
-    // Compute l_num_v many harmonic fields
-    Eigen::MatrixXd W;
-    LE_ASSERT(harmonic(_em.target_pos(), constrained, constraint_values, W, LaplaceWeights::MeanValue));
+    auto constraint_values = [&](int _l_v) {
+        Eigen::MatrixXd values = Eigen::MatrixXd::Zero(t_num_v, 1);
+        values(t_constrained_vertex[_l_v], 0) = 1.0;
+        return values;
+    };
 
-    return W;
+    // Failures are only recorded here, the fallback runs outside of the parallel region
+    std::vector<char> success(missing.size(), false);
+    #pragma omp parallel for
+    for (int k = 0; k < (int)missing.size(); ++k)
+    {
+        const int l_v = missing[k];
+        Eigen::MatrixXd W;
+        success[k] = solver.solve(constraint_values(l_v), W);
+        if (success[k])
+            fields.col(l_v) = W.col(0);
+    }
+
+    for (int k = 0; k < (int)missing.size(); ++k)
+    {
+        const int l_v = missing[k];
+        if (!success[k])
+        {
+            std::cout << "Vertex repulsive energy: Iterative solve failed, falling back to direct solver" << std::endl;
+            Eigen::MatrixXd W;
+            LE_ASSERT(solver.solve_direct(constraint_values(l_v), W));
+            fields.col(l_v) = W.col(0);
+        }
+        solved[l_v].store(true, std::memory_order_release);
+    }
+}
+
+void VertexRepulsiveEnergy::require(int _l_v)
+{
+    if (!is_solved(_l_v))
+        require(std::vector<int>{_l_v});
+}
+
+Eigen::MatrixXd::ConstColXpr VertexRepulsiveEnergy::field(int _l_v) const
+{
+    LE_ASSERT(is_solved(_l_v));
+    return fields.col(_l_v);
 }
 
 }
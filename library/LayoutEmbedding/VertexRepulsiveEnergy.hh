@@ -1,11 +1,48 @@
 #pragma once
 
 #include <LayoutEmbedding/Embedding.hh>
+#include <LayoutEmbedding/Harmonic.hh>
 
 #include <Eigen/Dense>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+
 namespace LayoutEmbedding {
 
-Eigen::MatrixXd compute_vertex_repulsive_energy(const Embedding& _em);
+/// Harmonic fields for vertex repulsive path tracing [Praun2001], one per layout vertex.
+/// The Laplacian is factorized once, and the field of a layout vertex is only solved when it is first required.
+/// Fields are stored in a single buffer, one contiguous column per layout vertex,
+/// and refer to the target mesh at construction time.
+/// Columns of fields that are never required are allocated but never written.
+/// Shared between copies of an Embedding. Thread-safe.
+class VertexRepulsiveEnergy
+{
+public:
+    explicit VertexRepulsiveEnergy(const Embedding& _em);
+
+    /// Solves the fields of the given layout vertices that are missing (in parallel).
+    /// Falls back to the direct solver if an iterative solve fails.
+    void require(const std::vector<int>& _l_vertices);
+    void require(int _l_v);
+
+    bool is_solved(int _l_v) const { return solved[_l_v].load(std::memory_order_acquire); }
+
+    /// Only valid after require() returned for _l_v.
+    Eigen::MatrixXd::ConstColXpr field(int _l_v) const;
+
+    /// Number of target vertices at construction time.
+    int num_target_vertices() const { return t_num_v; }
+
+private:
+    std::vector<int> t_constrained_vertex; // Target vertex index per layout vertex
+    int t_num_v;
+
+    HarmonicSolver solver;
+    Eigen::MatrixXd fields;                      // Target vertex x layout vertex
+    std::unique_ptr<std::atomic<bool>[]> solved; // Indexed by layout vertex
+    std::mutex mutex;
+};
 
 }
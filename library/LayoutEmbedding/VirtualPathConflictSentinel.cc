@@ -3,50 +3,97 @@
 #include <LayoutEmbedding/Util/Assert.hh>
 #include <LayoutEmbedding/Connectivity.hh>
 
+#include <algorithm>
+#include <exception>
 #include <unordered_map>
 
 namespace LayoutEmbedding {
 
+namespace {
+
+// Below this number of dirty layout vertices, the check is not worth spawning threads for.
+constexpr int min_num_vertices_parallel_check = 16;
+
+}
+
 VirtualPathConflictSentinel::VirtualPathConflictSentinel(const Embedding& _em) :
-    em(_em),
-    v_label(em.target_mesh()),
-    e_label(em.target_mesh()),
-    f_label(em.target_mesh()),
-    l_port(em.layout_mesh())
+    em(&_em),
+    l_port(_em.layout_mesh()),
+    ordering_conflicts(_em.layout_mesh().vertices().size())
 {
+    for (const auto l_v : em->layout_mesh().vertices()) {
+        dirty_vertices.insert(l_v.idx.value);
+    }
 }
 
-void VirtualPathConflictSentinel::insert(const pm::vertex_handle& _v, const VirtualPathConflictSentinel::Label& _l)
+void VirtualPathConflictSentinel::rebind(const Embedding& _em)
 {
-    for (const auto& prev_l : v_label[_v]) {
-        mark_conflicting(_l, prev_l);
+    em = &_em;
+
+    // Ports store handles, which refer to the target mesh of the previous Embedding
+    for (const auto l_he : em->layout_mesh().halfedges()) {
+        auto& port = l_port[l_he];
+        if (port.from.is_valid()) {
+            port.from = em->target_mesh().vertices()[port.from.idx];
+        }
     }
-    v_label[_v].insert(_l);
 }
 
-void VirtualPathConflictSentinel::insert(const pm::edge_handle& _e, const VirtualPathConflictSentinel::Label& _l)
+void VirtualPathConflictSentinel::insert(LabelStorage& _labels, std::vector<int>& _touched, int _idx, const Label& _l)
 {
-    for (const auto& prev_l : e_label[_e]) {
+    auto& labels = _labels[_idx];
+    if (std::find(labels.begin(), labels.end(), _l) != labels.end()) {
+        return;
+    }
+    for (const auto& prev_l : labels) {
         mark_conflicting(_l, prev_l);
     }
-    e_label[_e].insert(_l);
+    labels.push_back(_l);
+    _touched.push_back(_idx);
 }
 
-void VirtualPathConflictSentinel::insert(const pm::face_handle& _f, const VirtualPathConflictSentinel::Label& _l)
+void VirtualPathConflictSentinel::remove(LabelStorage& _labels, int _idx, const Label& _l)
 {
-    for (const auto& prev_l : f_label[_f]) {
-        mark_conflicting(_l, prev_l);
+    auto it_labels = _labels.find(_idx);
+    LE_ASSERT(it_labels != _labels.end());
+    auto& labels = it_labels->second;
+    labels.erase(std::find(labels.begin(), labels.end(), _l));
+    if (labels.empty()) {
+        _labels.erase(it_labels);
+        return;
+    }
+    for (const auto& other_l : labels) {
+        const Conflict sorted = std::minmax(_l, other_l);
+        auto it = element_conflict_count.find(sorted);
+        LE_ASSERT(it != element_conflict_count.end());
+        if (--it->second == 0) {
+            element_conflict_count.erase(it);
+        }
     }
-    f_label[_f].insert(_l);
+}
+
+void VirtualPathConflictSentinel::insert(const pm::vertex_handle& _v, const VirtualPathConflictSentinel::Label& _l)
+{
+    insert(v_label, touched[_l].vertices, _v.idx.value, _l);
+}
+
+void VirtualPathConflictSentinel::insert(const pm::edge_handle& _e, const VirtualPathConflictSentinel::Label& _l)
+{
+    insert(e_label, touched[_l].edges, _e.idx.value, _l);
+}
+
+void VirtualPathConflictSentinel::insert(const pm::face_handle& _f, const VirtualPathConflictSentinel::Label& _l)
+{
+    insert(f_label, touched[_l].faces, _f.idx.value, _l);
 }
 
 void VirtualPathConflictSentinel::insert_virtual_vertex(const VirtualVertex& _vv, const VirtualPathConflictSentinel::Label& _l)
 {
     if (is_real_vertex(_vv)) {
-        insert(real_vertex(_vv, em.target_mesh()), _l);
+        insert(real_vertex(_vv, em->target_mesh()), _l);
     }
     else {
-        insert(real_edge(_vv, em.target_mesh()), _l);
+        insert(real_edge(_vv, em->target_mesh()), _l);
     }
 }
 
@@ -55,8 +102,8 @@ void VirtualPathConflictSentinel::insert_segment(const VirtualVertex& _vv0, cons
     if (is_real_vertex(_vv0)) {
         if (is_real_vertex(_vv1)) {
             // (V,V) case
-            const auto& v0 = real_vertex(_vv0, em.target_mesh());
-            const auto& v1 = real_vertex(_vv1, em.target_mesh());
+            const auto& v0 = real_vertex(_vv0, em->target_mesh());
+            const auto& v1 = real_vertex(_vv1, em->target_mesh());
 
             const auto& he = pm::halfedge_from_to(v0, v1);
             LE_ASSERT(he.is_valid());
@@ -65,8 +112,8 @@ void VirtualPathConflictSentinel::insert_segment(const VirtualVertex& _vv0, cons
         }
         else {
             // (V,E) case
-            const auto& v = real_vertex(_vv0, em.target_mesh());
-            const auto& e = real_edge(_vv1, em.target_mesh());
+            const auto& v = real_vertex(_vv0, em->target_mesh());
+            const auto& e = real_edge(_vv1, em->target_mesh());
 
             const auto& f = triangle_with_edge_and_opposite_vertex(e, v);
             LE_ASSERT(f.is_valid());
@@ -76,8 +123,8 @@ void VirtualPathConflictSentinel::insert_segment(const VirtualVertex& _vv0, cons
     else {
         if (is_real_vertex(_vv1)) {
             // (E,V) case
-            const auto& e = real_edge(_vv0, em.target_mesh());
-            const auto& v = real_vertex(_vv1, em.target_mesh());
+            const auto& e = real_edge(_vv0, em->target_mesh());
+            const auto& v = real_vertex(_vv1, em->target_mesh());
 
             const auto& f = triangle_with_edge_and_opposite_vertex(e, v);
             LE_ASSERT(f.is_valid());
@@ -85,8 +132,8 @@ void VirtualPathConflictSentinel::insert_segment(const VirtualVertex& _vv0, cons
         }
         else {
             // (E,E) case
-            const auto& e0 = real_edge(_vv0, em.target_mesh());
-            const auto& e1 = real_edge(_vv1, em.target_mesh());
+            const auto& e0 = real_edge(_vv0, em->target_mesh());
+            const auto& e1 = real_edge(_vv1, em->target_mesh());
 
             const auto& f = common_face(e0, e1);
             LE_ASSERT(f.is_valid());
@@ -98,6 +145,9 @@ void VirtualPathConflictSentinel::insert_segment(const VirtualVertex& _vv0, cons
 void VirtualPathConflictSentinel::insert_path(const VirtualPath& _path, const VirtualPathConflictSentinel::Label& _l)
 {
     LE_ASSERT_GEQ(_path.size(), 2);
+    LE_ASSERT(!contains_path(_l));
+    touched[_l];
+    mark_dirty(_l);
 
     // Note: We deliberately skip the first and last element
     for (int i = 1; i < _path.size() - 1; ++i) {
@@ -115,195 +165,270 @@ void VirtualPathConflictSentinel::insert_path(const VirtualPath& _path, const Vi
 
     // Warning: Here we rely on the assumption that for each edge l_e, the corresponding path was traced
     // using find_shortest_path(l_e.halfedgeA());
-    const pm::edge_handle l_e = em.layout_mesh().edges()[_l];
-    LE_ASSERT(em.matching_target_vertex(l_e.halfedgeA().vertex_from()) == real_vertex(_path.front()));
-    LE_ASSERT(em.matching_target_vertex(l_e.halfedgeA().vertex_to()) == real_vertex(_path.back()));
+    const pm::edge_handle l_e = em->layout_mesh().edges()[_l];
+    LE_ASSERT(em->matching_target_vertex(l_e.halfedgeA().vertex_from()) == real_vertex(_path.front()));
+    LE_ASSERT(em->matching_target_vertex(l_e.halfedgeA().vertex_to()) == real_vertex(_path.back()));
 
-    const VirtualPort port_A(real_vertex(_path[0], em.target_mesh()), _path[1]);
-    const VirtualPort port_B(real_vertex(_path[_path.size()-1], em.target_mesh()), _path[_path.size()-2]);
+    const VirtualPort port_A(real_vertex(_path[0], em->target_mesh()), _path[1]);
+    const VirtualPort port_B(real_vertex(_path[_path.size()-1], em->target_mesh()), _path[_path.size()-2]);
     // Links from layout to target
     l_port[l_e.halfedgeA()] = port_A;
     l_port[l_e.halfedgeB()] = port_B;
 }
 
+void VirtualPathConflictSentinel::remove_path(const VirtualPathConflictSentinel::Label& _l)
+{
+    auto it = touched.find(_l);
+    LE_ASSERT(it != touched.end());
+    for (const auto& idx : it->second.vertices) {
+        remove(v_label, idx, _l);
+    }
+    for (const auto& idx : it->second.edges) {
+        remove(e_label, idx, _l);
+    }
+    for (const auto& idx : it->second.faces) {
+        remove(f_label, idx, _l);
+    }
+    touched.erase(it);
+
+    const pm::edge_handle l_e = em->layout_mesh().edges()[_l];
+    l_port[l_e.halfedgeA()] = VirtualPort();
+    l_port[l_e.halfedgeB()] = VirtualPort();
+    mark_dirty(_l);
+}
+
+bool VirtualPathConflictSentinel::contains_path(const VirtualPathConflictSentinel::Label& _l) const
+{
+    return touched.count(_l);
+}
+
+void VirtualPathConflictSentinel::mark_dirty(const VirtualPathConflictSentinel::Label& _l)
+{
+    // Sectors and ports change at both endpoints of the layout edge
+    const pm::edge_handle l_e = em->layout_mesh().edges()[_l];
+    dirty_vertices.insert(l_e.vertexA().idx.value);
+    dirty_vertices.insert(l_e.vertexB().idx.value);
+}
+
 void VirtualPathConflictSentinel::mark_conflicting(const VirtualPathConflictSentinel::Label& _a, const VirtualPathConflictSentinel::Label& _b)
 {
-    LE_ASSERT(!em.is_embedded(_a));
-    LE_ASSERT(!em.is_embedded(_b));
+    LE_ASSERT(!em->is_embedded(_a));
+    LE_ASSERT(!em->is_embedded(_b));
 
     if (_a == _b) {
         return;
     }
 
     const Conflict sorted = std::minmax(_a, _b);
-    conflict_relation.insert(sorted);
+    ++element_conflict_count[sorted];
 }
 
 void VirtualPathConflictSentinel::check_path_ordering()
 {
-    for (const auto l_v : em.layout_mesh().vertices()) {
-        bool vertex_has_sectors = false;
-        for (const auto l_sector_boundary_he : l_v.outgoing_halfedges()) {
-            if (em.is_embedded(l_sector_boundary_he)) {
-                vertex_has_sectors = true;
-
-                // A list of all unembedded layout edges that are in this sector,
-                // along with their corresponding embedded ports
-                std::vector<Label> labels_in_sector;
-                std::vector<VirtualPort> embedded_ports_in_sector;
-                {
-                    auto l_he_in_sector = rotated_ccw(l_sector_boundary_he);
-                    while (!em.is_embedded(l_he_in_sector)) {
-                        labels_in_sector.push_back(l_he_in_sector.edge());
-                        embedded_ports_in_sector.push_back(l_port[l_he_in_sector]);
-                        l_he_in_sector = rotated_ccw(l_he_in_sector);
-                    }
+    // Layout vertices are independent. The per-vertex check is const,
+    // and each iteration only assigns its own entry of ordering_conflicts.
+    // Shared state (element_conflict_count, conflict_relation) is only modified outside of this loop.
+    // Exceptions (from failed assertions) must not leave the parallel region, so they are rethrown after it.
+    const std::vector<int> l_vis(dirty_vertices.begin(), dirty_vertices.end());
+    std::vector<std::exception_ptr> errors(l_vis.size());
+    #pragma omp parallel for schedule(dynamic) if((int)l_vis.size() > min_num_vertices_parallel_check)
+    for (int i = 0; i < (int)l_vis.size(); ++i) {
+        try {
+            ordering_conflicts[l_vis[i]] = find_ordering_conflicts(em->layout_mesh().vertices()[pm::vertex_index(l_vis[i])]);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    }
+    for (const auto& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    dirty_vertices.clear();
+
+    // Collect conflicts from shared target elements and from the cyclic order around layout vertices
+    conflict_relation.clear();
+    for (const auto& [conflict, count] : element_conflict_count) {
+        conflict_relation.insert(conflict.first, conflict.second);
+    }
+    for (const auto& conflicts_at_vertex : ordering_conflicts) {
+        for (const auto& [l_a, l_b] : conflicts_at_vertex) {
+            conflict_relation.insert(l_a, l_b);
+        }
+    }
+}
+
+std::vector<VirtualPathConflictSentinel::Conflict> VirtualPathConflictSentinel::find_ordering_conflicts(const pm::vertex_handle& _l_v) const
+{
+    const auto& l_v = _l_v;
+    std::vector<Conflict> conflicts_at_vertex;
+    auto mark_ordering_conflict = [&](const Label& _a, const Label& _b) {
+        LE_ASSERT(!em->is_embedded(_a));
+        LE_ASSERT(!em->is_embedded(_b));
+        if (_a != _b) {
+            conflicts_at_vertex.push_back(std::minmax(_a, _b));
+        }
+    };
+
+    bool vertex_has_sectors = false;
+    for (const auto l_sector_boundary_he : l_v.outgoing_halfedges()) {
+        if (em->is_embedded(l_sector_boundary_he)) {
+            vertex_has_sectors = true;
+
+            // A list of all unembedded layout edges that are in this sector,
+            // along with their corresponding embedded ports
+            std::vector<Label> labels_in_sector;
+            std::vector<VirtualPort> embedded_ports_in_sector;
+            {
+                auto l_he_in_sector = rotated_ccw(l_sector_boundary_he);
+                while (!em->is_embedded(l_he_in_sector)) {
+                    labels_in_sector.push_back(l_he_in_sector.edge());
+                    embedded_ports_in_sector.push_back(l_port[l_he_in_sector]);
+                    l_he_in_sector = rotated_ccw(l_he_in_sector);
                 }
-                LE_ASSERT_EQ(labels_in_sector.size(), embedded_ports_in_sector.size());
-
-                // This map assigns each unembedded layout edge in the sector an integer position
-                // that corresponds to its index in the fan of possible outgoing ports in the
-                // corresponding sector on the target mesh.
-                std::map<Label, int> embedded_port_pos;
-                {
-                    const auto& t_v = em.matching_target_vertex(l_v);
-                    const auto& t_he = em.get_embedded_target_halfedge(l_sector_boundary_he);
-                    const auto start_port = VirtualPort(t_v, t_he.vertex_to());
-                    auto current_port = start_port.rotated_ccw();
-                    int current_port_pos = 0;
-                    while (true) {
-                        if (is_real_vertex(current_port.to)) {
-                            const auto& t_he_current = current_port.real_halfedge();
-                            if (em.is_blocked(t_he_current.edge())) {
-                                // Reached end of sector
-                                break;
-                            }
+            }
+            LE_ASSERT_EQ(labels_in_sector.size(), embedded_ports_in_sector.size());
+
+            // Assigns each unembedded layout edge in the sector (by its index in labels_in_sector)
+            // an integer position that corresponds to its index in the fan of possible outgoing ports
+            // in the corresponding sector on the target mesh.
+            std::vector<int> embedded_port_pos(labels_in_sector.size(), -1);
+            {
+                const auto& t_v = em->matching_target_vertex(l_v);
+                const auto& t_he = em->get_embedded_target_halfedge(l_sector_boundary_he);
+                const auto start_port = VirtualPort(t_v, t_he.vertex_to());
+                auto current_port = start_port.rotated_ccw();
+                int current_port_pos = 0;
+                while (true) {
+                    if (is_real_vertex(current_port.to)) {
+                        const auto& t_he_current = current_port.real_halfedge();
+                        if (em->is_blocked(t_he_current.edge())) {
+                            // Reached end of sector
+                            break;
                         }
+                    }
 
-                        // Store positions
-                        LE_ASSERT_EQ(labels_in_sector.size(), embedded_ports_in_sector.size());
-                        for (std::size_t i = 0; i < labels_in_sector.size(); ++i) {
-                            const auto& label = labels_in_sector[i];
-                            const auto& embedded_port = embedded_ports_in_sector[i];
-                            if (embedded_port == current_port) {
-                                embedded_port_pos[label] = current_port_pos;
-                            }
+                    // Store positions
+                    LE_ASSERT_EQ(labels_in_sector.size(), embedded_ports_in_sector.size());
+                    for (std::size_t i = 0; i < labels_in_sector.size(); ++i) {
+                        const auto& embedded_port = embedded_ports_in_sector[i];
+                        if (embedded_port == current_port) {
+                            embedded_port_pos[i] = current_port_pos;
                         }
-
-                        current_port = current_port.rotated_ccw();
-                        ++current_port_pos;
                     }
+
+                    current_port = current_port.rotated_ccw();
+                    ++current_port_pos;
                 }
-                // All incident edges in the layout sector should have a corresponding port in the target sector!
-                LE_ASSERT_EQ(labels_in_sector.size(), embedded_port_pos.size());
-
-                // Detect conflicting edges
-                for (std::size_t i = 0; i < labels_in_sector.size(); ++i) {
-                    const auto& label = labels_in_sector[i];
-                    const auto& port_pos = embedded_port_pos.at(label);
-
-                    for (std::size_t i_left = 0; i_left < i; ++i_left) {
-                        const auto& label_left = labels_in_sector[i_left];
-                        const auto& port_pos_left = embedded_port_pos.at(label_left);
-                        if (port_pos_left >= port_pos) {
-                            mark_conflicting(label, label_left);
-                        }
+            }
+            // All incident edges in the layout sector should have a corresponding port in the target sector!
+            LE_ASSERT(std::find(embedded_port_pos.begin(), embedded_port_pos.end(), -1) == embedded_port_pos.end());
+
+            // Detect conflicting edges
+            for (std::size_t i = 0; i < labels_in_sector.size(); ++i) {
+                const auto& label = labels_in_sector[i];
+                const auto& port_pos = embedded_port_pos[i];
+
+                for (std::size_t i_left = 0; i_left < i; ++i_left) {
+                    const auto& label_left = labels_in_sector[i_left];
+                    const auto& port_pos_left = embedded_port_pos[i_left];
+                    if (port_pos_left >= port_pos) {
+                        mark_ordering_conflict(label, label_left);
                     }
+                }
 
-                    for (std::size_t i_right = i + 1; i_right < labels_in_sector.size(); ++i_right) {
-                        const auto& label_right = labels_in_sector[i_right];
-                        const auto& port_pos_right = embedded_port_pos.at(label_right);
-                        if (port_pos_right <= port_pos) {
-                            mark_conflicting(label, label_right);
-                        }
+                for (std::size_t i_right = i + 1; i_right < labels_in_sector.size(); ++i_right) {
+                    const auto& label_right = labels_in_sector[i_right];
+                    const auto& port_pos_right = embedded_port_pos[i_right];
+                    if (port_pos_right <= port_pos) {
+                        mark_ordering_conflict(label, label_right);
                     }
                 }
             }
         }
+    }
 
-        if (!vertex_has_sectors) {
-            // Save back references -- from VirtualPorts around this vertex to corresponding layout halfedges.
-            std::unordered_map<VirtualPort, std::set<Label>> labels_at_port;
-            for (const auto l_he : l_v.outgoing_halfedges()) {
-                LE_ASSERT(!em.is_embedded(l_he));
-                const auto& port = l_port[l_he];
-                const auto& label = l_he.edge();
-                labels_at_port[port].insert(label);
-            }
+    if (!vertex_has_sectors) {
+        // Save back references -- from VirtualPorts around this vertex to corresponding layout halfedges.
+        // A flat list, since there are only as many entries as the valence of the layout vertex.
+        std::vector<std::pair<VirtualPort, Label>> labels_at_port;
+        for (const auto l_he : l_v.outgoing_halfedges()) {
+            LE_ASSERT(!em->is_embedded(l_he));
+            labels_at_port.push_back({l_port[l_he], l_he.edge()});
+        }
 
-            // Detect local violations of cyclic order
-            for (const auto l_he : l_v.outgoing_halfedges()) {
-                const pm::halfedge_handle& l_he_prev = rotated_cw(l_he);
-                const pm::halfedge_handle& l_he_next = rotated_ccw(l_he);
-
-                const Label& l_prev = l_he_prev.edge();
-                const Label& l      = l_he.edge();
-                const Label& l_next = l_he_next.edge();
-
-                const VirtualPort& port_prev = l_port[l_he_prev];
-                const VirtualPort& port      = l_port[l_he];
-                const VirtualPort& port_next = l_port[l_he_next];
-
-                LE_ASSERT(port_prev.is_valid());
-                LE_ASSERT(port.is_valid());
-                LE_ASSERT(port_next.is_valid());
-
-                // We check that port lies between port_prev and port_next.
-                // To do this, we start at port_prev, and rotate CCW until port is found.
-                // If any other embedded edge is encountered first, we have detected a conflict.
-                // We then repeat the same thing starting from port, trying to reach port_next.
-
-                bool valid = true;
-                auto port_current = port_prev;
-
-                // Check the sector from port_prev to port
-                while (port_current != port) {
-                    for (const auto& l_at_port : labels_at_port[port_current]) {
-                        // Any other labels at port_current?
-                        if (l_at_port != l_prev) {
-                            // --> Conflict
-                            valid = false;
-                            break;
-                        }
-                    }
-                    port_current = port_current.rotated_ccw();
+        // Any label other than _l at _port?
+        auto other_label_at_port = [&](const VirtualPort& _port, const Label& _l) {
+            for (const auto& [port_at, l_at_port] : labels_at_port) {
+                if (port_at == _port && l_at_port != _l) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // Detect local violations of cyclic order
+        for (const auto l_he : l_v.outgoing_halfedges()) {
+            const pm::halfedge_handle& l_he_prev = rotated_cw(l_he);
+            const pm::halfedge_handle& l_he_next = rotated_ccw(l_he);
+
+            const Label& l_prev = l_he_prev.edge();
+            const Label& l      = l_he.edge();
+            const Label& l_next = l_he_next.edge();
+
+            const VirtualPort& port_prev = l_port[l_he_prev];
+            const VirtualPort& port      = l_port[l_he];
+            const VirtualPort& port_next = l_port[l_he_next];
+
+            LE_ASSERT(port_prev.is_valid());
+            LE_ASSERT(port.is_valid());
+            LE_ASSERT(port_next.is_valid());
+
+            // We check that port lies between port_prev and port_next.
+            // To do this, we start at port_prev, and rotate CCW until port is found.
+            // If any other embedded edge is encountered first, we have detected a conflict.
+            // We then repeat the same thing starting from port, trying to reach port_next.
+
+            bool valid = true;
+            auto port_current = port_prev;
+
+            // Check the sector from port_prev to port
+            while (port_current != port) {
+                // Any other labels at port_current? --> Conflict
+                if (other_label_at_port(port_current, l_prev)) {
+                    valid = false;
                 }
+                port_current = port_current.rotated_ccw();
+            }
 
-                LE_ASSERT(port_current == port);
+            LE_ASSERT(port_current == port);
 
-                // Check the sector from port to port_next
-                while (port_current != port_next) {
-                    for (const auto& l_at_port : labels_at_port[port_current]) {
-                        // Any other labels at port_current?
-                        if (l_at_port != l) {
-                            // --> Conflict
-                            valid = false;
-                            break;
-                        }
-                    }
-                    port_current = port_current.rotated_ccw();
+            // Check the sector from port to port_next
+            while (port_current != port_next) {
+                // Any other labels at port_current? --> Conflict
+                if (other_label_at_port(port_current, l)) {
+                    valid = false;
                 }
+                port_current = port_current.rotated_ccw();
+            }
 
-                LE_ASSERT(port_current == port_next);
+            LE_ASSERT(port_current == port_next);
 
-                for (const auto& l_at_port : labels_at_port[port_next]) {
-                    // Any other labels at port_next?
-                    if (l_at_port != l_next) {
-                        // --> Conflict
-                        valid = false;
-                        break;
-                    }
-                }
+            // Any other labels at port_next? --> Conflict
+            if (other_label_at_port(port_next, l_next)) {
+                valid = false;
+            }
 
-                if (!valid) {
-                    // The current label (l) is marked as conflicting with all other incident labels around the vertex
-                    for (const auto other_l : l_v.edges()) {
-                        mark_conflicting(l, other_l);
-                    }
+            if (!valid) {
+                // The current label (l) is marked as conflicting with all other incident labels around the vertex
+                for (const auto other_l : l_v.edges()) {
+                    mark_ordering_conflict(l, other_l);
                 }
             }
         }
     }
+    return conflicts_at_vertex;
 }
 
 }
@@ -1,34 +1,46 @@
 #pragma once
 
+#include <LayoutEmbedding/ConflictGraph.hh>
 #include <LayoutEmbedding/Embedding.hh>
 #include <LayoutEmbedding/VirtualPath.hh>
 #include <LayoutEmbedding/VirtualPort.hh>
 #include <LayoutEmbedding/VirtualVertex.hh>
 #include <LayoutEmbedding/VirtualVertexAttribute.hh>
 
+#include <map>
+#include <unordered_map>
+
 namespace LayoutEmbedding {
 
+/// Detects conflicts among a set of labeled (candidate) paths on the target mesh of an Embedding.
+/// Paths can be inserted and removed individually. check_path_ordering() then only re-examines
+/// the layout vertices whose incident paths changed since the last call.
 struct VirtualPathConflictSentinel
 {
-    const Embedding& em;
+    const Embedding* em;
 
     using Segment = std::pair<VirtualVertex, VirtualVertex>;
     using Label = pm::edge_index;
-    using LabelSet = std::set<Label>;
+    using LabelList = std::vector<Label>; // Usually holds one or two labels
+    using LabelStorage = std::unordered_map<int, LabelList>;
 
-    using Conflict = std::pair<Label, Label>;
-    using ConflictSet = std::set<Conflict>;
+    using Conflict = ConflictGraph::Conflict;
 
-    pm::vertex_attribute<LabelSet> v_label;
-    pm::edge_attribute<LabelSet> e_label;
-    pm::face_attribute<LabelSet> f_label;
+    // Labels per target mesh element, keyed by element index.
+    // Only elements touched by a path have an entry, so the sentinel is cheap to construct and copy.
+    LabelStorage v_label;
+    LabelStorage e_label;
+    LabelStorage f_label;
 
-    ConflictSet conflict_relation; // The pairs of labels which are conflicting
+    ConflictGraph conflict_relation; // The pairs of labels which are conflicting. Up to date after check_path_ordering().
 
     pm::halfedge_attribute<VirtualPort> l_port;
 
     explicit VirtualPathConflictSentinel(const Embedding& _em);
 
+    /// To be called after the sentinel was copied along with its Embedding.
+    void rebind(const Embedding& _em);
+
     void insert(const pm::vertex_handle& _v, const Label& _l);
     void insert(const pm::edge_handle& _e, const Label& _l);
     void insert(const pm::face_handle& _f, const Label& _l);
@@ -36,9 +48,32 @@ struct VirtualPathConflictSentinel
     void insert_segment(const VirtualVertex& _vv0, const VirtualVertex& _vv1, const Label& _l);
     void insert_path(const VirtualPath& _path, const Label& _l);
 
+    /// Removes all traces of the path with label _l.
+    /// Only relies on stored element indices, so it also works after the target mesh was refined.
+    void remove_path(const Label& _l);
+    bool contains_path(const Label& _l) const;
+
     void mark_conflicting(const Label& _a, const Label& _b);
 
     void check_path_ordering();
+
+private:
+    struct TouchedElements
+    {
+        std::vector<int> vertices;
+        std::vector<int> edges;
+        std::vector<int> faces;
+    };
+
+    void insert(LabelStorage& _labels, std::vector<int>& _touched, int _idx, const Label& _l);
+    void remove(LabelStorage& _labels, int _idx, const Label& _l);
+    void mark_dirty(const Label& _l);
+    std::vector<Conflict> find_ordering_conflicts(const pm::vertex_handle& _l_v) const; // Read-only, safe to run in parallel
+
+    std::map<Label, TouchedElements> touched;              // Elements carrying each inserted label
+    std::map<Conflict, int> element_conflict_count;        // Number of shared elements per conflicting pair
+    std::vector<std::vector<Conflict>> ordering_conflicts; // Per layout vertex
+    std::set<int> dirty_vertices;                          // Layout vertices to re-check
 };
 
 }